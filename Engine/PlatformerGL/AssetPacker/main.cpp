@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/io/assetpack.hpp"
+
+namespace fs = std::filesystem;
+
+// builds the asset pack of the game from its Assets and Bin trees:
+// AssetPacker [-o Assets.pack] [--store] [directories...], run from the directory holding them
+int main(int argc, char** argv)
+{
+    std::string packFile = Core::IO::AssetPack::packFile;
+    std::vector<std::string> roots;
+    bool compress = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "-o" && i + 1 < argc)
+            packFile = argv[++i];
+        else if (argument == "--store")
+            compress = false;
+        else
+            roots.push_back(argument);
+    }
+    if (roots.empty())
+        roots = { "Assets", "Bin" };
+
+    std::vector<Core::IO::AssetPack::Source> sources;
+    for (const std::string& root : roots)
+    {
+        std::error_code error;
+        for (const fs::directory_entry& entry : fs::recursive_directory_iterator(root, error))
+        {
+            if (!entry.is_regular_file())
+                continue;
+
+            std::string path = Core::IO::AssetPack::normalize(entry.path().generic_string());
+            std::string filename = entry.path().filename().string();
+
+            // generated: baked meshes, saved games, stress scenes, streamed world cells and the packs themselves
+            if (path.rfind("Assets/cache/", 0) == 0 || filename.rfind("save_", 0) == 0 || filename.rfind("stress_", 0) == 0
+                || entry.path().parent_path().extension() == ".world"
+                || entry.path().extension() == ".pack" || entry.path().extension() == ".tmp")
+                continue;
+
+            sources.push_back({ path, entry.path().string() });
+        }
+
+        if (error)
+            std::cerr << "Unable to read directory: " << root << std::endl;
+    }
+
+    // same input, same pack
+    std::sort(sources.begin(), sources.end(), [](const auto& a, const auto& b) { return a.path < b.path; });
+
+    Core::IO::AssetPack::BuildStats stats;
+    if (!Core::IO::AssetPack::build(sources, packFile, compress, stats))
+    {
+        std::cerr << "Unable to build " << packFile << std::endl;
+        return 1;
+    }
+
+    std::cout << packFile << ": " << stats.files << " files, " << stats.blobs << " blobs ("
+        << stats.files - stats.blobs << " duplicates), " << stats.compressed << " compressed | "
+        << stats.inputBytes / 1024 << " KB -> " << stats.packBytes / 1024 << " KB" << std::endl;
+
+    // every entry read back through the table and checked against its file
+    Core::IO::AssetPack& pack = Core::IO::AssetPack::getInstance();
+    if (!pack.mount(packFile))
+    {
+        std::cerr << "Unable to mount " << packFile << std::endl;
+        return 1;
+    }
+
+    std::vector<char> buffer;
+    for (const Core::IO::AssetPack::Source& source : sources)
+    {
+        const char* data = nullptr;
+        size_t size = 0;
+        uint64_t expectedSize = 0;
+        uint64_t contentHash = 0;
+        if (!pack.stat(source.path, expectedSize, contentHash) || !pack.read(source.path, data, size, buffer)
+            || size != expectedSize || Core::IO::AssetPack::hash(data, size) != contentHash)
+        {
+            std::cerr << "Pack check failed: " << source.path << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -1,13 +1,12 @@
 #version 450 core
 
-layout (location = 0) in vec3	aPos;
-layout (location = 1) in vec4	aColor;
-layout (location = 2) in vec3	aNormal;
-layout (location = 3) in vec2	aTexCoord;
+layout (location = 0) in vec3	aPos;		// normalized in the mesh bounds
 
 uniform mat4 mvp;
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
 
 void main()
 {
-	gl_Position = vec4(aPos, 1.0) * mvp ;
+	gl_Position = vec4(aPos * positionScale + positionOffset, 1.0) * mvp ;
 };
\ No newline at end of file
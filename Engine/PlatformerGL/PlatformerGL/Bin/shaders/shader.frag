@@ -3,6 +3,7 @@
 #define NR_DIR_LIGHTS 00
 #define NR_POINT_LIGHTS 00
 #define NR_SPOT_LIGHTS 00
+#define MAX_MATERIALS 256
 
 out vec4 FragColor;
 
@@ -12,11 +13,27 @@ in vec3 FragPos;
 
 uniform int DirLightCount;
 uniform sampler2D ourTexture;
+uniform sampler2DArray textureArray;    // unit 1, set by the TexturePacker
+uniform int textureLayer;               // -1 when the texture of the mesh is not packed
+uniform vec4 textureRect;               // uv offset and scale in the layer
 uniform vec3 camPos;
 uniform vec3 modelColor;
 uniform bool textureEnabled;
 uniform bool outline;
 uniform vec3 outlineColor;
+uniform int materialIndex;
+uniform bool diffuseMapBound;
+
+// MTL values, filled by the MaterialRegistry
+struct Material {
+    vec4 ambient;       // Ka
+    vec4 diffuse;       // Kd, d
+    vec4 specular;      // Ks, Ns
+};
+
+layout (std140, binding = 1) uniform Materials {
+    Material materials[MAX_MATERIALS];
+};
 
 struct PointLight {  
     bool enabled;
@@ -62,9 +79,10 @@ struct SpotLight {
 uniform SpotLight spotLights[NR_SPOT_LIGHTS];
 
 
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);  
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec4 SampleDiffuse();
+vec3 CalcDirLight(DirLight light, Material material, vec3 normal, vec3 viewDir);  
+vec3 CalcPointLight(PointLight light, Material material, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcSpotLight(SpotLight light, Material material, vec3 normal, vec3 fragPos, vec3 viewDir);
 
 void main()
 {
@@ -80,28 +98,42 @@ void main()
     {
         vec3 norm = normalize(Normal);
         vec3 viewDir = normalize(camPos - FragPos);
+        Material material = materials[materialIndex];
 
         // Calculate Directional light
         for (int i = 0; i < NR_DIR_LIGHTS; ++i)
-            result += CalcDirLight(dirLights[i], norm, viewDir);
+            result += CalcDirLight(dirLights[i], material, norm, viewDir);
 
         // Calculate point light color
         for (int i = 0; i < NR_POINT_LIGHTS; ++i)
-            result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
+            result += CalcPointLight(pointLights[i], material, norm, FragPos, viewDir);
 
         for (int i = 0; i < NR_SPOT_LIGHTS; ++i)
-            result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);
+            result += CalcSpotLight(spotLights[i], material, norm, FragPos, viewDir);
 
-        if (textureEnabled)
-            FragColor = vec4(result, 1.0) * texture(ourTexture, TexCoord);
+        float opacity = material.diffuse.a;
+        if (!textureEnabled)
+            FragColor = vec4(result * modelColor, opacity);
+        else if (diffuseMapBound)
+            FragColor = vec4(result, opacity) * SampleDiffuse();
         else
-            FragColor = vec4(result * modelColor, 1.0);
+            FragColor = vec4(result, opacity);
     }
 	
     
 };
 
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec4 SampleDiffuse()
+{
+    if (textureLayer < 0)
+        return texture(ourTexture, TexCoord);
+
+    // the uvs repeat inside the rect, the gradients of the unwrapped uvs keep the mip level across the seams
+    vec2 uv = textureRect.xy + fract(TexCoord) * textureRect.zw;
+    return textureGrad(textureArray, vec3(uv, float(textureLayer)), dFdx(TexCoord) * textureRect.zw, dFdy(TexCoord) * textureRect.zw);
+}
+
+vec3 CalcSpotLight(SpotLight light, Material material, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
     if (light.enabled)
     {
@@ -113,7 +145,7 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
             float diff = max(dot(normal, lightDir), 0.0);
             // specular shading
             vec3 reflectDir = reflect(-lightDir, normal);
-            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+            float spec = pow(max(dot(viewDir, reflectDir), 0.0), max(material.specular.w, 1.0));
 
             // attenuation
             float distance    = length(light.position - fragPos);
@@ -121,9 +153,9 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
   	    		         light.quadratic * (distance * distance));
 
             // combine results
-            vec3 ambient  = light.ambient;
-            vec3 diffuse  = light.diffuse  * diff;
-            vec3 specular = light.specular * spec;
+            vec3 ambient  = light.ambient  * material.ambient.rgb;
+            vec3 diffuse  = light.diffuse  * diff * material.diffuse.rgb;
+            vec3 specular = light.specular * spec * material.specular.rgb;
             ambient  *= attenuation;
             diffuse  *= attenuation;
             specular *= attenuation;
@@ -131,12 +163,12 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
             return (ambient + diffuse + specular);
         }
         else
-            return light.ambient * 0.01;
+            return light.ambient * material.ambient.rgb * 0.01;
     }
     return vec3(0.0, 0.0, 0.0);
 }
 
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+vec3 CalcDirLight(DirLight light, Material material, vec3 normal, vec3 viewDir)
 {
     if (light.enabled)
     {
@@ -147,12 +179,12 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
 
         // specular shading
         vec3 reflectDir = reflect(-lightDir, normal);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), max(material.specular.w, 1.0));
 
         // combine results
-        vec3 ambient  = light.ambient;
-        vec3 diffuse  = light.diffuse  * diff;
-        vec3 specular = light.specular * spec;
+        vec3 ambient  = light.ambient  * material.ambient.rgb;
+        vec3 diffuse  = light.diffuse  * diff * material.diffuse.rgb;
+        vec3 specular = light.specular * spec * material.specular.rgb;
 
         return (ambient + diffuse + specular);
         
@@ -161,7 +193,7 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
     
 }  
 
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcPointLight(PointLight light, Material material, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
     if (light.enabled)
     {
@@ -173,7 +205,7 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 
         // specular shading
         vec3 reflectDir = reflect(-lightDir, normal);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32); // 32 - shininess(Ns value in .mtl)
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), max(material.specular.w, 1.0));
 
         // attenuation
         float distance    = length(light.position - fragPos);
@@ -181,9 +213,9 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
   	    		     light.quadratic * (distance * distance));    
 
         // combine results
-        vec3 ambient  = light.ambient;            //* vec3(texture(material.diffuse, TexCoords)); (if implemented remove ambientStrength)
-        vec3 diffuse  = light.diffuse  * diff;                      //* vec3(texture(material.diffuse, TexCoords));
-        vec3 specular = light.specular * spec;   //* vec3(texture(material.specular, TexCoords)); (if implemented remove specularStrength)
+        vec3 ambient  = light.ambient  * material.ambient.rgb;
+        vec3 diffuse  = light.diffuse  * diff * material.diffuse.rgb;
+        vec3 specular = light.specular * spec * material.specular.rgb;
         ambient  *= attenuation;
         diffuse  *= attenuation;
         specular *= attenuation;
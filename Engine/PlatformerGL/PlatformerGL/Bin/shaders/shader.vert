@@ -1,8 +1,7 @@
 #version 450 core
 
-layout (location = 0) in vec3	aPos;
-layout (location = 1) in vec4	aColor;
-layout (location = 2) in vec3	aNormal;
+layout (location = 0) in vec3	aPos;		// normalized in the mesh bounds
+layout (location = 2) in vec2	aNormal;	// octahedral
 layout (location = 3) in vec2	aTexCoord;
 
 out vec2 TexCoord;
@@ -11,16 +10,29 @@ out vec3 FragPos;
 
 uniform mat4 mvp;
 uniform mat4 modelMat4;
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+vec3 octDecode(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
 
 void main()
 {
-	gl_Position = vec4(aPos, 1.0) * mvp;
-	FragPos = vec3(vec4(aPos, 1.0) * modelMat4);
+	vec3 position = aPos * positionScale + positionOffset;
+	vec3 normal = octDecode(aNormal);
+
+	gl_Position = vec4(position, 1.0) * mvp;
+	FragPos = vec3(vec4(position, 1.0) * modelMat4);
 	
     TexCoord = aTexCoord;
 	//Normal = (modelMat4 * vec4(aNormal, 0.0)).xyz;
     //Normal = aNormal;
 
    //calculation needed when model is not scaled uniformly
-   Normal = mat3(transpose(inverse(modelMat4))) * aNormal;  
+   Normal = mat3(transpose(inverse(modelMat4))) * normal;  
 };
\ No newline at end of file
@@ -41,6 +41,7 @@ class Application
 		void						updateInputs();
 		void						updatePlayerInputs();
 		bool						getJumpInput();
+		bool						getSaveInput();
 		void						updateCameraInputs();
 
 		//game
@@ -73,6 +74,7 @@ class Application
 		float						mouseDeltaY = 0.0;
 
 		int							currScene = 0;
+		int							saveState = GLFW_RELEASE;
 
 		GameState					gs = GameState::INMENU;
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+
+namespace Core
+{
+	namespace DataStructure
+	{
+		// fixed capacity FIFO shared between producer threads and one consumer. Nothing ever waits on it:
+		// a full queue refuses the item, the producers keep no more items in flight than the capacity
+		// so the consumer alone decides how much decoded data is held
+		template<typename T>
+		class BoundedQueue
+		{
+		public:
+			BoundedQueue(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+			BoundedQueue(const BoundedQueue& other) = delete;
+			void					operator=(const BoundedQueue& other) = delete;
+
+			// false when the queue is full or closed, the item is then left to the caller
+			bool					tryPush(T& item);
+			bool					tryPop(T& item);
+			void					close();
+
+			inline size_t			size() const { std::lock_guard<std::mutex> lock(mutex); return items.size(); }
+			inline size_t			getCapacity() const { return capacity; }
+
+		private:
+			std::deque<T>			items;
+			size_t					capacity;
+			bool					closed = false;
+
+			mutable std::mutex		mutex;
+		};
+
+		template<typename T>
+		bool BoundedQueue<T>::tryPush(T& item)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (closed || items.size() >= capacity)
+				return false;
+
+			items.push_back(std::move(item));
+			return true;
+		}
+
+		template<typename T>
+		bool BoundedQueue<T>::tryPop(T& item)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (items.empty())
+				return false;
+
+			item = std::move(items.front());
+			items.pop_front();
+			return true;
+		}
+
+		template<typename T>
+		void BoundedQueue<T>::close()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+		}
+	}
+}
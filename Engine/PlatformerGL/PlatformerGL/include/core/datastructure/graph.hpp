@@ -2,10 +2,13 @@
 
 #include <vector>
 #include <map>
+#include <future>
 #include <string>
 
 #include "resources/resourcesmanager.hpp"
 #include "resources/scene.hpp"
+#include "resources/scenejournal.hpp"
+#include "resources/worldstreamer.hpp"
 
 namespace Core
 {
@@ -15,6 +18,7 @@ namespace Core
 		{
 		public:
 			Graph() = default;
+			~Graph();
 			
 			Graph(const Graph& graph) = delete;
 
@@ -24,10 +28,19 @@ namespace Core
 
 			void							loadScenes();
 			void							unloadScenes();
+			// copies the live state of the scenes, the journals are written by a worker
 			void							saveScenes();
 			void							loadSavedScene();
 			void							setScenes();
 			bool							hasSavedScene();
+			void							reloadChangedAssets();
+
+			// loads and evicts the cells of a streamed scene around its first player, once per frame
+			void							streamWorld(int index);
+			const Resources::WorldStreamer*	getWorld(int index) const;
+
+			// scene_list.txt scenes to Bin/scenes/<scene>.pglscene, or their saves to Bin/scenes/save_<scene>.scn
+			void							convertScenes(bool toSnapshots);
 
 			Resources::ResourcesManager		rm;
 
@@ -35,20 +48,20 @@ namespace Core
 
 		private:
 			void							parseSceneList(std::vector<std::string>& sceneList, const char* filePath) const;
-			void							loadScene(const bool saved);
-			bool endOfLine(int iplus1, std::string& line);
-			void editLightCounts();
-			void							saveScene();
-			void							loadModels(std::map<std::string, std::vector<float>>& models, 
-												std::vector<std::string>& modelNames, 
-												std::map<std::string, std::vector<float>>& colliders,
-												const std::vector<std::string>& colliderNames,
-												const std::vector<std::string>& shaderInfo,
-												std::map<int, std::vector<int>>& gameObjects,
-												const std::vector<std::string>& customTextures
-											);
+			void							loadScene(Resources::Scene& scene, const bool saved);
+			void editLightCounts(Resources::Scene& scene);
+			// current transforms, colliders, health and camera in the order of the records of the scene
+			void							captureScene(const Resources::Scene& scene, const Resources::SceneData& source, Resources::SceneState& state) const;
+			// the journals belong to the save job while it runs, the decoded textures are uploaded meanwhile
+			void							waitForSave(bool uploading = true);
 
 			std::vector<Resources::Scene>	scenes;
+
+			// saves of each loaded scene, by scene name, with the records it was built from
+			std::map<std::string, Resources::SceneJournal>	journals;
+			// cells of the streamed scenes, by scene name: their objects are listed by the scenes being played
+			std::map<std::string, Resources::WorldStreamer>	worlds;
+			std::future<void>				pendingSave;
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Core
+{
+	namespace DataStructure
+	{
+		// fixed set of worker threads shared by the loaders
+		class ThreadPool
+		{
+		private:
+			ThreadPool();
+
+		public:
+			static ThreadPool& getInstance()
+			{
+				static ThreadPool instance;
+
+				return instance;
+			}
+
+			~ThreadPool();
+
+			ThreadPool(const ThreadPool& other) = delete;
+			void							operator=(const ThreadPool& other) = delete;
+
+			template<typename F>
+			auto							submit(F&& job) -> std::future<decltype(job())>;
+
+			// runs job(0) .. job(count - 1) on the workers and the calling thread, returns when all are done
+			void							parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+			inline size_t					workerCount() const { return workers.size(); }
+
+		private:
+			void							push(std::function<void()> job);
+			void							workerLoop();
+
+			std::vector<std::thread>		workers;
+			std::deque<std::function<void()>> jobs;
+			std::mutex						jobsMutex;
+			std::condition_variable			jobsCondition;
+			bool							stopping = false;
+		};
+
+		template<typename F>
+		auto ThreadPool::submit(F&& job) -> std::future<decltype(job())>
+		{
+			using Result = decltype(job());
+
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+			std::future<Result> result = task->get_future();
+			push([task]() { (*task)(); });
+
+			return result;
+		}
+	}
+}
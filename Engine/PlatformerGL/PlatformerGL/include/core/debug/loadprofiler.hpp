@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Core
+{
+	namespace Debug
+	{
+		enum class LoadStage
+		{
+			OBJ_PARSE,
+			MESH_OPTIMIZE,
+			MESH_LODS,
+			MTL_PARSE,
+			TEXTURE_DECODE,
+			GL_UPLOAD,
+			SHADER_COMPILE,
+			COUNT
+		};
+
+		// wall time and bytes of every asset loaded during a session, with the hits and misses of the resource caches.
+		// The report is a table sorted by time in the logs and the full records in Logs/load_profile.json.
+		// Records come from the loading threads as well as the GL thread
+		class LoadProfiler
+		{
+		private:
+			LoadProfiler() = default;
+
+		public:
+			static LoadProfiler& getInstance()
+			{
+				static LoadProfiler instance;
+
+				return instance;
+			}
+
+			LoadProfiler(const LoadProfiler& other) = delete;
+			void				operator=(const LoadProfiler& other) = delete;
+
+			// times the enclosing block, the bytes may be set before it ends
+			class Scope
+			{
+			public:
+				Scope(LoadStage stage, const std::string& name);
+				~Scope();
+
+				Scope(const Scope& other) = delete;
+				void			operator=(const Scope& other) = delete;
+
+				size_t			bytes = 0;
+
+			private:
+				LoadStage		stage;
+				std::string		name;
+				std::chrono::steady_clock::time_point	start;
+			};
+
+			// drops the records of the previous session, nothing is recorded outside of one
+			void				begin(const std::string& session);
+			void				record(LoadStage stage, const std::string& name, double milliseconds, size_t bytes);
+			void				cacheHit(const std::string& cache);
+			void				cacheMiss(const std::string& cache);
+
+			// the streamed textures and the mesh uploads following the load are part of it: the report is written
+			// by the first update() of the main loop, called every frame, that finds no job pending
+			void				finish(size_t pendingJobs);
+			void				update(size_t pendingJobs);
+
+			static bool			enabled;
+			static size_t		tableRows;		// slowest assets listed in the logs, the JSON has all of them
+
+		private:
+			struct Record
+			{
+				LoadStage		stage;
+				std::string		name;
+				double			milliseconds;
+				size_t			bytes;
+			};
+
+			struct CacheStats
+			{
+				size_t			hits = 0;
+				size_t			misses = 0;
+			};
+
+			void				report();
+			void				writeJson(double wallMilliseconds) const;
+
+			std::mutex			mutex;
+			std::vector<Record>	records;
+			std::map<std::string, CacheStats>	caches;
+			std::string			session;
+			std::chrono::steady_clock::time_point	start;
+			bool				recording = false;
+			bool				finishing = false;
+		};
+	}
+}
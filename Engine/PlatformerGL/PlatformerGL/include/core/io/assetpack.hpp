@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "core/io/mappedfile.hpp"
+
+namespace Core
+{
+	namespace IO
+	{
+		// single file archive of the Assets and Bin trees (.pack) read through one mapping: a hashed table
+		// of contents over blobs aligned to 64 bytes, each optionally compressed and identified by the hash
+		// of its content so identical files are stored once. Built by the AssetPacker tool
+		class AssetPack
+		{
+		private:
+			AssetPack();
+
+		public:
+			static AssetPack& getInstance()
+			{
+				static AssetPack instance;
+
+				return instance;
+			}
+
+			AssetPack(const AssetPack& other) = delete;
+			void					operator=(const AssetPack& other) = delete;
+
+			// false when the file is missing or is not a pack of this version
+			bool					mount(const std::string& packFile);
+			void					unmount();
+
+			inline bool				isMounted() const { return entryCount > 0; }
+			inline size_t			getEntryCount() const { return entryCount; }
+
+			// stored entries point into the mapping, compressed ones are decoded into the buffer (any thread)
+			bool					read(const std::string& path, const char*& data, size_t& size, std::vector<char>& buffer) const;
+			bool					contains(const std::string& path) const;
+			bool					stat(const std::string& path, uint64_t& size, uint64_t& contentHash) const;
+
+			// the loose file was edited after packing, it is read from the disk from now on
+			void					invalidate(const std::string& path);
+
+			// name of a file in the pack: relative, forward slashes, no dot segments
+			static std::string		normalize(const std::string& path);
+			static uint64_t			hash(const char* data, size_t size);
+
+			struct Source
+			{
+				std::string			path;		// name in the pack
+				std::string			file;		// file read from the disk
+			};
+
+			struct BuildStats
+			{
+				size_t				files = 0;
+				size_t				blobs = 0;
+				size_t				compressed = 0;
+				uint64_t			inputBytes = 0;
+				uint64_t			packBytes = 0;
+			};
+
+			// entries only compressed when it saves an eighth of their size at least
+			static bool				build(const std::vector<Source>& sources, const std::string& packFile, bool compress, BuildStats& stats);
+
+			static std::string		packFile;		// mounted at the first use
+			static bool				enabled;
+
+		private:
+			struct Header;
+			struct Entry;
+
+			const Entry*			find(const std::string& path) const;
+
+			MappedFile				file;
+			const Header*			header = nullptr;
+			const Entry*			entries = nullptr;
+			const uint32_t*			slots = nullptr;
+			const char*				names = nullptr;
+			size_t					entryCount = 0;
+
+			std::set<std::string>	invalidated;
+			mutable std::mutex		invalidatedMutex;
+		};
+
+		// read-only view of an asset, from the mounted pack or from the loose file when the pack does not hold it
+		class AssetFile
+		{
+		public:
+			AssetFile() = default;
+			AssetFile(const std::string& path);
+
+			AssetFile(const AssetFile& other) = delete;
+			void					operator=(const AssetFile& other) = delete;
+
+			bool					open(const std::string& path);
+
+			inline bool				isOpen() const { return opened; }
+			inline bool				isPacked() const { return packed; }
+			inline const char*		data() const { return bytes; }
+			inline size_t			size() const { return length; }
+
+		private:
+			MappedFile				loose;
+			std::vector<char>		buffer;
+			const char*				bytes = nullptr;
+			size_t					length = 0;
+			bool					opened = false;
+			bool					packed = false;
+		};
+	}
+}
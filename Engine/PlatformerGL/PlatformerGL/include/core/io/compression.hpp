@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+namespace Core
+{
+	namespace IO
+	{
+		// byte oriented LZ77 codec (LZ4 block layout): sequences of literals followed by a match
+		// of at least 4 bytes within the previous 64 KB. Fast to decode, used for the text assets of the packs
+		class Compression
+		{
+		public:
+			Compression() = delete;
+			Compression(const Compression& other) = delete;
+			void			operator=(const Compression& other) = delete;
+
+			static void		compress(const char* data, size_t size, std::vector<char>& compressed);
+
+			// false when the data is corrupt or does not decode to exactly size bytes
+			static bool		decompress(const char* compressed, size_t compressedSize, char* data, size_t size);
+
+			// bytes decoded per compressed byte at most, a match length byte of 255 being the longest output
+			static constexpr size_t	maxRatio = 255;
+		};
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Core
+{
+	namespace IO
+	{
+		// reports the watched files written since the last poll, with inotify on the directories
+		// holding them on Linux and by comparing modification times elsewhere
+		class FileWatcher
+		{
+		public:
+			FileWatcher();
+			~FileWatcher();
+
+			FileWatcher(const FileWatcher& other) = delete;
+			void				operator=(const FileWatcher& other) = delete;
+
+			void				watch(const std::string& path);
+			void				clear();
+
+			// paths as given to watch(), each one at most once per call
+			std::vector<std::string>	poll();
+
+			static float		pollInterval;		// seconds between two scans of the modification times
+
+		private:
+			std::map<std::string, std::string>	files;	// normalized path, path given to watch()
+
+#ifdef __linux__
+			int					inotifyDescriptor = -1;
+			std::map<int, std::string>			directories;	// watch descriptor, normalized directory
+			std::map<std::string, int>			directoryWatches;
+#else
+			std::map<std::string, std::filesystem::file_time_type>	writeTimes;
+			std::chrono::steady_clock::time_point					lastScan;
+#endif
+		};
+	}
+}
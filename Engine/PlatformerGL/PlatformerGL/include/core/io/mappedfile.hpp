@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+namespace Core
+{
+	namespace IO
+	{
+		// read-only view of a whole file mapped into memory
+		class MappedFile
+		{
+		public:
+			MappedFile() = default;
+			MappedFile(const std::string& path);
+			~MappedFile();
+
+			MappedFile(const MappedFile& other) = delete;
+			void				operator=(const MappedFile& other) = delete;
+
+			bool				open(const std::string& path);
+			void				close();
+
+			inline bool			isOpen() const { return opened; }
+			inline const char*	data() const { return bytes; }
+			inline size_t		size() const { return length; }
+
+		private:
+			const char*			bytes = nullptr;
+			size_t				length = 0;
+			bool				opened = false;
+
+#ifdef _WIN32
+			void*				fileHandle = nullptr;
+			void*				mappingHandle = nullptr;
+#else
+			int					fileDescriptor = -1;
+#endif
+		};
+	}
+}
@@ -34,9 +34,9 @@ namespace Game
 		void						fillMesh(const std::vector<Resources::Mesh>& meshes);
 		void						addMesh(const std::string& resourceInfo);
 		void						addMesh();
-		void						loadTextures(const std::vector<std::string>& materials, const std::vector<std::string>& texFiles,
-										std::map<std::string, unsigned int>& cachedTextures
-									);
+		std::vector<std::string>	textureFiles(const Resources::MaterialLibrary& library) const;
+		void						setTextures(const std::vector<Resources::TextureHandle>& textures);
+		void						setMaterials(const Resources::MaterialLibrary& library);
 		void						defineVAO();
 		virtual void                showImGuiControls();
 
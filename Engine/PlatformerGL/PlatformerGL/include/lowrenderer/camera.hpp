@@ -38,8 +38,10 @@ namespace LowRenderer
             mat4   getProjection() const;
             mat4   getMVP(const mat4& model) const;
             vec3   getCamPos() const;
+            float  getFovY() const;
 
-            float*              getCamInfo() const;
+            // the values of a scene file camera record
+            std::vector<float>  getCamInfo() const;
 
         private:
             void                debug() const;
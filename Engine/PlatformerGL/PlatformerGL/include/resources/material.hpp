@@ -0,0 +1,108 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "core/maths/maths.hpp"
+
+namespace Resources
+{
+	// surface of one newmtl entry of an MTL file, the defaults keep the lighting of a surface
+	// whose file does not give the value
+	struct Material
+	{
+		enum class Map
+		{
+			AMBIENT,		// map_Ka
+			DIFFUSE,		// map_Kd
+			SPECULAR,		// map_Ks
+			SHININESS,		// map_Ns
+			OPACITY,		// map_d
+			BUMP,			// map_Bump, bump
+			COUNT
+		};
+
+		std::string			name;
+		Core::Maths::vec3	ambient = { 1.f, 1.f, 1.f };		// Ka
+		Core::Maths::vec3	diffuse = { 1.f, 1.f, 1.f };		// Kd
+		Core::Maths::vec3	specular = { 1.f, 1.f, 1.f };		// Ks
+		float				shininess = 32.f;					// Ns
+		float				opacity = 1.f;						// d, or 1 - Tr
+
+		std::string			maps[int(Map::COUNT)];				// texture files, empty when the slot is unused
+
+		inline const std::string&	map(Map slot) const { return maps[int(slot)]; }
+	};
+
+	// slot of a registered material in the uniform buffer, the default material when not set
+	class MaterialHandle
+	{
+	public:
+		MaterialHandle() = default;
+
+		inline unsigned int		index() const { return slot; }
+
+	private:
+		friend class MaterialRegistry;
+
+		MaterialHandle(unsigned int slot) : slot(slot) {}
+
+		unsigned int			slot = 0;
+	};
+
+	// materials of one MTL file by name
+	struct MaterialLibrary
+	{
+		std::map<std::string, MaterialHandle>	materials;
+
+		// the default material when the name is not in the file
+		MaterialHandle			find(const std::string& name) const;
+	};
+
+	// materials of every parsed MTL file, each file is parsed once and its materials shared by handle
+	// between the meshes. All of them live in one uniform block indexed by the fragment shader (GL thread only)
+	class MaterialRegistry
+	{
+	private:
+		MaterialRegistry();
+
+	public:
+		static MaterialRegistry& getInstance()
+		{
+			static MaterialRegistry instance;
+
+			return instance;
+		}
+
+		MaterialRegistry(const MaterialRegistry& other) = delete;
+		void					operator=(const MaterialRegistry& other) = delete;
+
+		// a file already registered keeps the slots of its materials and takes the new values
+		const MaterialLibrary&	add(const std::string& materialsFile, std::vector<Material>&& fileMaterials);
+
+		// an empty library when the file is not registered
+		const MaterialLibrary&	find(const std::string& materialsFile) const;
+		bool					contains(const std::string& materialsFile) const;
+		const Material&			get(MaterialHandle handle) const;
+
+		// writes the materials to the uniform buffer if they changed since the last call
+		void					upload();
+
+		inline size_t			getCount() const { return materials.size(); }
+
+		// must match MAX_MATERIALS and the binding of the Materials block of the shaders
+		static constexpr unsigned int	maxMaterials = 256;
+		static constexpr unsigned int	bindingPoint = 1;
+
+	private:
+		std::vector<Material>	materials;
+		std::map<std::string, MaterialLibrary>	libraries;
+
+		GLuint					buffer = 0;
+		bool					dirty = true;
+		bool					fullReported = false;
+	};
+}
@@ -1,14 +1,16 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
-#include <string>
 
 #include <glad/glad.h>
 
 #include "core/core.hpp"
 #include "core/maths/maths.hpp"
+#include "resources/material.hpp"
 #include "resources/texture.hpp"
+#include "resources/vertexformat.hpp"
 #include "physics/transform.hpp"
 
 namespace Resources
@@ -19,6 +21,74 @@ namespace Resources
         QUAD
     };
 
+    // geometry shared by every mesh built from the same file, it is immutable once created
+    // and uploaded once in a compact format, the CPU arrays are then released unless they were asked for.
+    // The LODs are coarser index lists on the same vertices, all levels go in one index buffer
+    class MeshData
+    {
+    public:
+        MeshData(
+            std::vector<Core::rdrVertex>&& vertices, std::vector<unsigned int>&& indices,
+            std::vector<std::vector<unsigned int>>&& lods
+        );
+        ~MeshData();
+
+        MeshData(const MeshData& other) = delete;
+        void                            operator=(const MeshData& other) = delete;
+
+        // creates the buffers on the first call only (GL thread only)
+        void                            upload(bool keepCpuData);
+
+        inline const std::vector<Core::rdrVertex>&  getVertices() const { return rdrVertices; }
+        inline const std::vector<unsigned int>&     getIndices() const { return indices; }
+        inline const std::vector<std::vector<unsigned int>>&    getLods() const { return lods; }
+        inline size_t                   getVertexCount() const { return vertexCount; }
+        inline size_t                   getIndexCount() const { return indexCount; }
+        inline GLuint                   getVAO() const { return VAO; }
+        inline GLenum                   getIndexType() const { return indexType; }
+
+        // level 0 is the full mesh
+        inline int                      getLevelCount() const { return int(levels.size()); }
+        inline size_t                   getLevelIndexCount(int level) const { return levels[level].count; }
+        inline const void*              getLevelOffset(int level) const { return reinterpret_cast<const void*>(levels[level].offset); }
+
+        // model space bounding sphere
+        inline const Core::Maths::vec3& getBoundsCenter() const { return boundsCenter; }
+        inline float                    getBoundsRadius() const { return boundsRadius; }
+        inline bool                     isUploaded() const { return VAO != 0; }
+        inline size_t                   getGpuBytes() const { return gpuBytes; }
+
+        // decode of the packed positions, set as uniforms of the vertex shaders
+        inline const Core::Maths::vec3& getPositionScale() const { return positionScale; }
+        inline const Core::Maths::vec3& getPositionOffset() const { return positionOffset; }
+
+    private:
+        struct Level
+        {
+            size_t                      offset;     // bytes in the index buffer
+            size_t                      count;
+        };
+
+        std::vector<Core::rdrVertex>    rdrVertices;
+        std::vector<unsigned int>       indices;
+        std::vector<std::vector<unsigned int>>  lods;
+        size_t                          vertexCount = 0;
+        size_t                          indexCount = 0;
+        std::vector<Level>              levels;
+
+        Core::Maths::vec3               boundsCenter = { 0.f, 0.f, 0.f };
+        float                           boundsRadius = 0.f;
+
+        GLenum                          indexType = GL_UNSIGNED_INT;
+        Core::Maths::vec3               positionScale = { 1.f, 1.f, 1.f };
+        Core::Maths::vec3               positionOffset = { 0.f, 0.f, 0.f };
+
+        GLuint                          VAO = 0;
+        GLuint                          VBO = 0;
+        GLuint                          EBO = 0;
+        size_t                          gpuBytes = 0;       // vertex and index buffers
+    };
+
     class Mesh
     {
     public:
@@ -28,23 +98,29 @@ namespace Resources
 
         void                            operator=(const Mesh& other);
 
-        void	                        setIndices();
+        // indices default to one per vertex when none are given
+        void                            setGeometry(
+                                            std::vector<Core::rdrVertex>&& vertices, std::vector<unsigned int>&& indices,
+                                            std::vector<std::vector<unsigned int>>&& lods = {}
+                                        );
         void                            defineVAO();
 
+        inline const MeshData&          getData() const { return *data; }
+        inline bool                     hasData() const { return data != nullptr; }
+
         FaceType                        faceType = FaceType::TRIANGLE;
         
         Resources::Texture              texture;
-        std::vector<Core::rdrVertex>    rdrVertices;
-        std::vector<unsigned int>       indices;
+        Resources::MaterialHandle       material;
 
         Physics::Transform              worldTransform;
         std::string	                    materialsInfo;
 
-        GLuint                          VAO = 0;
-        GLuint                          EBO = 0;
+        int                             lod = 0;    // level drawn by this instance
+
+        static bool                     keepCpuData;
 
     private:
-        void                            processVAO();
-        void                            setAttributes();
+        std::shared_ptr<MeshData>       data;
     };
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "resources/mesh.hpp"
+#include "physics/transform.hpp"
+
+namespace Resources
+{
+	// baked binary copy of the meshes of a model (.pglmesh), written after the first OBJ import
+	// and reused while the sources keep the same size and modification time (or content hash)
+	// and the meshes would be processed with the same settings.
+	// Vertices and indices are stored compressed by MeshCodec
+	class MeshCache
+	{
+	public:
+		MeshCache() = delete;
+		MeshCache(const MeshCache& other) = delete;
+		void				operator=(const MeshCache& other) = delete;
+
+		// one file per model and collider pair, the same model is baked again with another collider
+		static std::string	cachePath(const std::string& modelName, const std::string& colliderName);
+
+		static bool			load(const std::string& cacheFile, const std::vector<std::string>& sources,
+								const Physics::Transform& transform, std::string& materialsFile, std::vector<Mesh>& meshes
+							);
+		static bool			save(const std::string& cacheFile, const std::vector<std::string>& sources,
+								const std::string& materialsFile, const std::vector<Mesh>& meshes
+							);
+
+		// disabling it forces every model to be parsed from its OBJ files
+		static bool			enabled;
+		static std::string	directory;
+	};
+}
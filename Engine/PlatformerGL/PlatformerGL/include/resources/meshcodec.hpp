@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Resources
+{
+	// lossless compression of the vertex and index streams of the baked meshes.
+	// Elements are coded by chunks of 16: vertices as byte-wise deltas to the previous vertex and indices
+	// as zigzag deltas to the previous index, each split in byte planes whose groups of 16 bytes are
+	// stored on the fewest bits (0, 2, 4 or 8) holding all their values
+	class MeshCodec
+	{
+	public:
+		MeshCodec() = delete;
+		MeshCodec(const MeshCodec& other) = delete;
+		void			operator=(const MeshCodec& other) = delete;
+
+		// stride in bytes, up to maxStride
+		static void		encodeVertices(const void* vertices, size_t count, size_t stride, std::vector<unsigned char>& encoded);
+		static bool		decodeVertices(void* vertices, size_t count, size_t stride, const unsigned char* encoded, size_t size);
+
+		static void		encodeIndices(const unsigned int* indices, size_t count, std::vector<unsigned char>& encoded);
+		static bool		decodeIndices(unsigned int* indices, size_t count, const unsigned char* encoded, size_t size);
+
+		// most elements an encoded stream of the size can hold, every chunk of 16 taking at least its header.
+		// Lets a reader reject a count before allocating for it
+		static size_t	maxCount(size_t size, size_t stride);
+
+		// logs the ratio and decode speed on the meshes of the OBJ files of the directory
+		static void		benchmark(const std::string& directory);
+
+		static constexpr size_t	maxStride = 256;
+	};
+}
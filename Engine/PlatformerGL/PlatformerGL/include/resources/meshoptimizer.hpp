@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+#include "core/core.hpp"
+
+namespace Resources
+{
+	// reorders indexed triangle lists for the GPU: triangles for the post-transform vertex cache (Tipsify),
+	// clusters of them front to back for overdraw, then vertices in first use order for fetch locality
+	class MeshOptimizer
+	{
+	public:
+		MeshOptimizer() = delete;
+		MeshOptimizer(const MeshOptimizer& other) = delete;
+		void				operator=(const MeshOptimizer& other) = delete;
+
+		// cache misses of the triangle list through a FIFO vertex cache, the ACMR is misses per triangle
+		static size_t		cacheMisses(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize);
+
+		static void			optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize);
+		static void			optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Core::rdrVertex>& vertices, unsigned int cacheSize);
+		static void			optimizeVertexFetch(std::vector<Core::rdrVertex>& vertices, std::vector<unsigned int>& indices);
+
+		// runs the three passes and returns the cache misses before and after
+		static void			optimize(
+								std::vector<Core::rdrVertex>& vertices, std::vector<unsigned int>& indices,
+								size_t& missesBefore, size_t& missesAfter
+							);
+
+		// applied to every imported OBJ mesh, the cache size is the one simulated for the GPU
+		static bool			enabled;
+		static unsigned int	cacheSize;
+	};
+}
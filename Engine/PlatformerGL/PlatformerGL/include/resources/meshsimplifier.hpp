@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "core/core.hpp"
+
+namespace Resources
+{
+	// quadric error metric edge collapse working on the index buffer only, every level keeps the vertices
+	// of the full mesh so the levels of a mesh share its vertex buffer. Vertices on uv/normal seams and
+	// on open borders are never moved, which keeps textures and silhouettes in place
+	class MeshSimplifier
+	{
+	public:
+		MeshSimplifier() = delete;
+		MeshSimplifier(const MeshSimplifier& other) = delete;
+		void				operator=(const MeshSimplifier& other) = delete;
+
+		// collapses edges until the index count is reached or the next collapse would move the surface
+		// by more than targetError (relative to the mesh extent), resultError gets the error reached
+		static std::vector<unsigned int>	simplify(
+												const std::vector<Core::rdrVertex>& vertices, const std::vector<unsigned int>& indices,
+												size_t targetIndexCount, float targetError, float* resultError = nullptr
+											);
+
+		// coarser levels after the full mesh, each one about half the triangles of the previous,
+		// levels that do not remove at least a fifth of the triangles are not kept
+		static std::vector<std::vector<unsigned int>>	buildLods(
+												const std::vector<Core::rdrVertex>& vertices, const std::vector<unsigned int>& indices
+											);
+
+		static bool			enabled;
+		static int			lodCount;
+		static float		maxError;		// of the coarsest level, relative to the mesh extent
+	};
+}
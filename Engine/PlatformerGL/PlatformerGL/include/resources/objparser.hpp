@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core/core.hpp"
+#include "resources/mesh.hpp"
+
+namespace Resources
+{
+	// geometry of one material group of an OBJ file, faces are fan triangulated
+	// and identical vertices shared through the index buffer
+	struct ObjMesh
+	{
+		std::string						materialsInfo;
+		FaceType						faceType = FaceType::TRIANGLE;
+		std::vector<Core::rdrVertex>	rdrVertices;
+		std::vector<unsigned int>		indices;
+		std::vector<std::vector<unsigned int>>	lods;	// coarser levels on the same vertices
+	};
+
+	struct ObjData
+	{
+		std::string						materialsFile;
+		std::vector<ObjMesh>			meshes;
+
+		// vertex cache misses of all meshes before and after ObjParser::optimize, 0 until it runs
+		size_t							cacheMissesBefore = 0;
+		size_t							cacheMissesAfter = 0;
+	};
+
+	// OBJ reader working in place on a memory mapped file:
+	// lines are scanned as views and numbers parsed without temporary strings
+	class ObjParser
+	{
+	public:
+		ObjParser() = delete;
+		ObjParser(const ObjParser& other) = delete;
+		void				operator=(const ObjParser& other) = delete;
+
+		static bool			parseFile(const std::string& filename, ObjData& data);
+		static void			parse(const char* text, size_t size, ObjData& data);
+
+		// parses every .obj of the directory and logs the throughput in MB/s
+		static void			benchmark(const std::string& directory);
+
+		// merges the vertices with the same position, normal and uv and remaps the indices
+		static void			weld(ObjMesh& mesh);
+
+		// reorders the parsed meshes with MeshOptimizer when enabled, timed as its own load stage
+		static void			optimize(const std::string& filename, ObjData& data);
+
+		// LODs of the parsed meshes from MeshSimplifier when enabled, timed as its own load stage
+		static void			buildLods(const std::string& filename, ObjData& data);
+
+		// files bigger than the threshold are split in line aligned chunks parsed on the thread pool,
+		// disabling it forces the serial path
+		static bool			parallelEnabled;
+		static size_t		parallelThreshold;
+
+	private:
+		static void			parseSerial(const char* text, size_t size, ObjData& data);
+		static void			parseParallel(const char* text, size_t size, ObjData& data);
+	};
+}
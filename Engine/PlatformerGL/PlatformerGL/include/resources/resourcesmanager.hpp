@@ -1,11 +1,15 @@
 #pragma once
 
 #include <map>
+#include <set>
 
 #include "resources/shader.hpp"
 #include "resources/mesh.hpp"
+#include "resources/material.hpp"
 #include "resources/scene.hpp"
+#include "resources/sceneparser.hpp"
 #include "resources/texture.hpp"
+#include "core/io/filewatcher.hpp"
 
 namespace Resources
 {
@@ -14,7 +18,8 @@ namespace Resources
 		MESH = 1,
 		TEXTURE = 2,
 		SHADER = 3,
-		SCENE = 4
+		SCENE = 4,
+		MATERIAL = 5
 	};
 
 	class ResourcesManager
@@ -25,41 +30,46 @@ namespace Resources
 		ResourcesManager(const ResourcesManager& other) = delete;
 		void					operator=(const ResourcesManager& other) = delete;
 
-		void					addResource(
-									const int resourceType, const std::vector<std::string>& modelShaders
-								);
-		void					addResource(
-									const int resourceType, const std::string& resourceInfo, 
-									const bool collider
-								);
 		void					addResource(
 									const int resourceType, const std::string& resourceInfo
 								);
 		void					addResource(const int resourceType, const int value);
-		void					loadObj(std::string& modelName, const std::vector<float>& modelAttrib, 
-									const std::string& colliderName, const std::vector<float>& colliderAttrib,
-									const std::vector<std::string>& modelShaders, const std::vector<int>& gameObjAttrib,
-									const std::string& customTexture
-								);
+
+		// builds the game objects of the scene: OBJ, MTL and texture files are read on the
+		// thread pool, shaders and GL uploads are done on the calling (GL) thread
+		void					loadModels(Scene& scene, const std::vector<ModelInfo>& models);
+
+		// rebuilds the meshes, materials, textures and shader programs whose files changed and patches
+		// the game objects using them, in the loaded scenes and in the copies being played (GL thread only)
+		void					reloadChanged(std::vector<Scene>& liveScenes);
 
 		std::vector<Scene>		scenes;
 		unsigned int			count = 0;
-		int						latestTag = 0;
 
-	private:
-		bool					loadObj(const char* modelFile, const char* colliderFile, const std::string& modelName);
+		static bool				hotReload;
 
-		void					loadCachedGO(const std::string& modelName);
-		void					loadMaterials();
-		void					parseMtl(std::vector<std::string>& materials, std::vector<std::string>& texFiles);
-		void					loadTextures(const std::vector<std::string>& materials, const std::vector<std::string>& texFiles);
+	private:
+		bool					loadObj(
+									const std::string& modelName, const std::string& colliderName,
+									const Physics::Transform& transform, std::vector<Mesh>& meshes, std::string& materialsFile
+								) const;
+		bool					parseMtl(const std::string& materialsFile, std::vector<Material>& materials) const;
 
+		// material and texture of every mesh of the game object, the texture files are watched from now on
+		void					applyMaterials(Game::GameObject& gameObject);
+		void					track(const std::string& path, ResourceType type, const std::string& name);
+		void					reloadMesh(const std::string& modelName, const std::vector<Game::GameObject*>& gameObjects);
+		void					reloadMaterials(const std::string& materialsFile, const std::vector<Game::GameObject*>& gameObjects);
+		void					reloadShader(const std::string& shaderFile, const std::vector<Game::GameObject*>& gameObjects);
 
 		std::map<std::string, std::vector<Resources::Mesh>> cachedModelMeshes;
 		std::map<std::string, std::string>					cachedMTLFiles;
-		std::map<std::string, std::string>					cachedMTLNames;
-		std::map<std::string, bool>							cachedModelType;
+		std::map<std::string, std::string>					cachedColliderNames;
+		// gfx and collider programs by shader files and light counts
+		std::map<std::string, std::pair<Shader, Shader>>	cachedShaders;
 
-		std::map<std::string, unsigned int>					cachedTextures;
+		// watched file, resources built from it
+		std::map<std::string, std::set<std::pair<ResourceType, std::string>>>	dependencies;
+		Core::IO::FileWatcher								watcher;
 	};
-}
\ No newline at end of file
+}
@@ -58,13 +58,23 @@ namespace Resources
 
 		std::string name;
 
+		size_t										trianglesDrawn = 0;		// last frame
+		mutable size_t								textureBinds = 0;		// last frame
+
+		// LOD n is drawn below lodThreshold / 2^(n-1) of the screen height,
+		// the hysteresis is the margin needed to leave the current level
+		static bool									lodEnabled;
+		static float								lodThreshold;
+		static float								lodHysteresis;
+
 	private:
 		void								updateColliderPos();
 		void								clearBackground() const;
 		void								drawModel(LowRenderer::Model& model, int index, bool outlinePass = false, bool isCollider = false) const;
-		void drawCollider(Resources::Mesh& mesh, std::vector<Core::rdrVertex>& rdrVertex) const;
-		void drawGFX(Resources::Mesh& mesh, LowRenderer::Model& model, std::vector<Core::rdrVertex>& rdrVertex) const;
-		void verifyFaceType(Resources::Mesh& mesh, std::vector<Core::rdrVertex>& rdrVertex) const;
+		void drawCollider(Resources::Mesh& mesh) const;
+		void drawGFX(Resources::Mesh& mesh, LowRenderer::Model& model) const;
+		void								bindTexture(const Resources::Mesh& mesh) const;
+		void verifyFaceType(Resources::Mesh& mesh) const;
 		void								setModel(Physics::Transform& transform, LowRenderer::Model& model, Game::Tag& tag, bool outlinePass = false, bool isCollider = false);
 		void								update(const LowRenderer::CameraInputs& inputs, const Game::Input& playerInputs, bool gameMode);
 		void								updateCamera(const LowRenderer::CameraInputs& inputs, bool gameMode);
@@ -72,6 +82,10 @@ namespace Resources
 		void								draw(bool gameMode);
 		void								drawPlayers();
 		void								drawGameObjects(bool gameMode);
+		int									selectLod(const Resources::Mesh& mesh, const Physics::Transform& transform) const;
+		// part of the screen height covered by the bounding sphere, infinite from inside it
+		float								screenSize(const Resources::Mesh& mesh, const Physics::Transform& transform) const;
+		void								requestTextureDetail(const Resources::Mesh& mesh, const Physics::Transform& transform) const;
 
 		Core::Maths::mat4					calcModelMat4(Physics::Transform& transform) const;
 
@@ -87,5 +101,10 @@ namespace Resources
 		float								modelColliderOffset = 1.f;
 
 		bool								constantTransformations = false;
+		float								viewportHeight = 0.f;	// pixels, read at the start of the frame
+
+		// bound by the previous draw of the frame, packed meshes only rebind when their array changes
+		mutable unsigned int				boundTexture = 0;
+		mutable unsigned int				boundArray = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "resources/sceneparser.hpp"
+
+namespace Resources
+{
+	// live values of the models of a scene in the order of their records, copied on the main thread when saving
+	struct SceneState
+	{
+		static const size_t		stride = 16;		// transform, tag and collider of a model
+
+		std::vector<float>		values;
+		std::vector<int>		health;				// first game object attribute of every model
+		std::vector<float>		camera;
+		bool					compressed = true;
+	};
+
+	// incremental saves of a scene: the save_<scene>.pglscene snapshot followed by save_<scene>.pgljournal,
+	// one record appended per save with the models that changed since the previous one. The journal is tied
+	// to its snapshot by a hash and is folded into a new snapshot once it has grown.
+	// A streamed game only holds its resident objects, its saves go to save_<scene>.stream.* so a full save is never replaced
+	class SceneJournal
+	{
+	public:
+		// applies the journal of the save to the records of its snapshot, a journal written for another
+		// snapshot is ignored and a torn record ends the replay
+		void				replay(const std::string& sceneName, SceneData& data, bool streamed = false);
+
+		// records the game objects of the scene were built from, the first save is compared against them.
+		// A save replayed from the files of the other kind is written again whole to the files of this one
+		void				reset(const std::string& sceneName, std::shared_ptr<const SceneData> source, bool streamed = false);
+
+		// worker thread: appends the changed models to the journal or writes a new snapshot
+		bool				commit(const SceneState& state);
+
+		inline const SceneData*	getSource() const { return source.get(); }
+
+		static std::string	path(const std::string& sceneName, bool streamed = false);
+
+		// the streamed save was written last, or is the only one
+		static bool			latestIsStreamed(const std::string& sceneName);
+
+		static size_t		compactRecords;		// records appended before the journal is folded into the snapshot
+
+	private:
+		bool				append(const SceneState& state, size_t& changed);
+		bool				compact(const SceneState& state);
+
+		std::string			sceneName;
+		std::shared_ptr<const SceneData>	source;
+		SceneState			saved;				// state of the files on disk
+		uint64_t			snapshotHash = 0;
+		size_t				snapshotBytes = 0;
+		size_t				journalBytes = 0;	// 0 starts a new journal
+		size_t				records = 0;
+		bool				continuing = false;	// the snapshot on disk is the one of the loaded save
+		bool				streamed = false;	// resident objects only, in the files of a streamed game
+	};
+}
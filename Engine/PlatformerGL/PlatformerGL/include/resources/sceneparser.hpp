@@ -0,0 +1,54 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Resources
+{
+	// model entry of a scene file with everything needed to build its game object
+	struct ModelInfo
+	{
+		std::string					name;
+		std::vector<float>			attribs;			// transform followed by the tag
+		std::string					colliderName;
+		std::vector<float>			colliderAttribs;
+		std::vector<std::string>	shaders;
+		std::vector<int>			gameObjectAttribs;
+		std::string					customTexture = "None";
+	};
+
+	// records of a .scn file, the models in file order: instances of the same model, placed prefabs
+	// included, are separate entries
+	struct SceneData
+	{
+		std::vector<ModelInfo>			models;
+		std::vector<float>				camera;
+		std::vector<std::vector<float>>	dirLights;
+		std::vector<std::vector<float>>	pointLights;
+		std::vector<std::vector<float>>	spotLights;
+
+		size_t							lineCount = 0;
+		size_t							errorCount = 0;		// malformed lines, skipped
+	};
+
+	// SCN reader: one record per line, dispatched on its keyword ("m", "t", "co", "s", "c", "ld", "lp", "ls",
+	// "prefab", "place", "array", "grid" or a tag code), numbers separated by blanks or '/' parsed without
+	// temporary strings. "t", "co" and "s" records belong to the last "m" record; malformed lines are logged
+	// with their number.
+	// A "prefab NAME {" ... "}" block holds one model whose transform is the offset of its instances:
+	//   place NAME x y z[/rx ry rz/sx sy sz]			one instance
+	//   array NAME x y z/dx dy dz/count				count instances, a step apart
+	//   grid NAME x y z/dx dy dz/nx ny nz				nx * ny * nz instances
+	class SceneParser
+	{
+	public:
+		SceneParser() = delete;
+		SceneParser(const SceneParser& other) = delete;
+		void				operator=(const SceneParser& other) = delete;
+
+		// false when the file cannot be opened
+		static bool			parseFile(const std::string& filename, SceneData& data);
+		static void			parse(const char* text, size_t size, const std::string& filename, SceneData& data);
+	};
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+#include "resources/sceneparser.hpp"
+
+namespace Resources
+{
+	// binary copy of the records of a scene (.pglscene): the asset references in one string table and
+	// the transforms, colliders, attributes, camera and lights as flat arrays, read and written in bulk.
+	// The payload may be stored compressed. SCN text stays the authoring format, convert() goes both ways
+	class SceneSnapshot
+	{
+	public:
+		SceneSnapshot() = delete;
+		SceneSnapshot(const SceneSnapshot& other) = delete;
+		void				operator=(const SceneSnapshot& other) = delete;
+
+		// written to a temporary file renamed over the previous one
+		static bool			save(const std::string& file, const SceneData& data, bool compressed);
+		static bool			load(const std::string& file, SceneData& data);
+
+		// SCN text of the records, numbers written back exactly
+		static bool			saveText(const std::string& file, const SceneData& data);
+
+		// reads a .scn or .pglscene file, by extension, into its records
+		static bool			loadAny(const std::string& file, SceneData& data);
+
+		// .scn to .pglscene or the other way, according to the extension of the destination
+		static bool			convert(const std::string& source, const std::string& destination);
+
+		static bool			isSnapshot(const std::string& file);
+
+		// Bin/scenes/save_<scene>.pglscene, save_<scene>.stream.pglscene for a streamed game
+		static std::string	savePath(const std::string& sceneName, bool streamed = false);
+
+		static bool			compressed;		// used by the saves and convert()
+		static const char*	extension;
+	};
+}
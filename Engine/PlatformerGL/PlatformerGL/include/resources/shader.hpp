@@ -6,6 +6,8 @@
 
 #include "core/core.hpp"
 #include "core/maths/maths.hpp"
+#include "core/debug/log.hpp"
+#include "core/io/assetpack.hpp"
 
 namespace Resources
 {
@@ -26,19 +28,29 @@ namespace Resources
 		void			setInt(const std::string& name, const int value) const;
 		void			setBool(const std::string& name, const bool value) const;
 
+		// compiles the files again into a new program, the current one is kept if they fail to compile
+		bool			reload();
+
 		GLuint			vertexShader = 0;  // DELETE
 		GLuint			fragmentShader = 0;  // DELETE
 		GLuint			shaderProgram = 0;
 
+		std::string		vertexFile = "";
+		std::string		fragFile = "";
+		Core::Maths::vec3	lightCounts = { 0.f, 0.f, 0.f };
+		bool			hasLightCounts = false;
+
 	private:
 		void			initShader();
 		void			getShaderSources();
 		void			getShaderSources(const Core::Maths::vec3& lightCounts);
 		void			setShaderLightCount(std::string& fragFileContent, std::string& replacing,  int& pos, const std::string& lightCount);
-		void			verifyFiles(std::ifstream& vertexFile, std::ifstream& fragmentFile);
-		void			initShaderProgram();
+		void			verifyFiles(const Core::IO::AssetFile& vertexFile, const Core::IO::AssetFile& fragmentFile);
+		bool			initShaderProgram();
 
 		std::string		fragShaderString = "";
 		std::string		vertexShaderString = "";
+
+		Core::Debug::LogType	failureLog = Core::Debug::LogType::ERROR;	// a reload must not exit on a bad edit
 	};
 }
\ No newline at end of file
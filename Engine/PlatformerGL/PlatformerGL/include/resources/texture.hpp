@@ -1,9 +1,31 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+#include "resources/textureregistry.hpp"
 
 namespace Resources
 {
+	// decoded texture in its source channel count with its whole mip chain, level 0 first,
+	// all levels are packed in one allocation
+	struct TextureImage
+	{
+		struct Level
+		{
+			int					width = 0;
+			int					height = 0;
+			size_t				offset = 0;
+		};
+
+		int						channels = 0;
+		std::vector<Level>		levels;
+		std::vector<unsigned char>	pixels;
+
+		inline bool				valid() const { return !levels.empty(); }
+		inline const unsigned char*	levelData(size_t level) const { return pixels.data() + levels[level].offset; }
+	};
+
 	class Texture
 	{
 	public:
@@ -15,12 +37,19 @@ namespace Resources
 		unsigned int		bindTexture();
 		void				processTexData(const std::string& textureFile);
 
+		// decoding and mip generation only touch memory and may run on any thread,
+		// the upload needs the GL context. Levels finer than firstLevel are left out of the texture
+		static bool				decode(const std::string& textureFile, TextureImage& image);
+		static void				generateMips(TextureImage& image);
+		void					upload(const std::string& textureFile, const TextureImage& image, int firstLevel = 0);
+
 		unsigned int		texCount;
 		int					width;
 		int					height;
 
+		TextureHandle		handle;		// keeps a registered texture resident
+
 	private:
 		void				debug(const std::string& textureFile);
-		unsigned char*      loadImage(std::string& filename, int& width, int& height);
 	};
 }
\ No newline at end of file
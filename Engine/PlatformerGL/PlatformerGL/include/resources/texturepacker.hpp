@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include "resources/textureregistry.hpp"
+
+namespace Resources
+{
+	// copies the resident textures into GL_TEXTURE_2D_ARRAYs so meshes with different textures share one binding:
+	// textures of the same size and format become the layers of one array with their mip chain, the small
+	// remaining ones are packed in RGBA atlas pages with a wrapped border and reached through a uv rect.
+	// The registry textures are left as they are, they stay the source of a reload or a repack (GL thread only)
+	class TexturePacker
+	{
+	private:
+		TexturePacker() = default;
+
+	public:
+		static TexturePacker& getInstance()
+		{
+			static TexturePacker instance;
+
+			return instance;
+		}
+
+		TexturePacker(const TexturePacker& other) = delete;
+		void					operator=(const TexturePacker& other) = delete;
+
+		// replaces the previous arrays and sets the slot of every entry, unpacked ones get an empty slot
+		void					pack(const std::vector<TextureHandle::Entry*>& entries);
+		void					clear(const std::vector<TextureHandle::Entry*>& entries);
+
+		void					showImGuiControls();
+
+		static bool				enabled;
+		static int				atlasSize;			// texels, width and height of a page
+		static int				atlasPadding;		// texels around every atlas texture, bounds the atlas mips
+		static int				atlasMaxTexture;	// bigger textures alone in their size keep their own texture
+
+		size_t					arrayCount = 0;
+		size_t					layerCount = 0;
+		size_t					atlasTextures = 0;
+		size_t					atlasPages = 0;
+		size_t					unpacked = 0;
+		size_t					bytes = 0;
+
+	private:
+		std::vector<unsigned int>	arrays;
+	};
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace Resources
+{
+	class TextureRegistry;
+	class TexturePacker;
+	struct TextureImage;
+
+	// place of a texture copied by the TexturePacker: a layer of a GL_TEXTURE_2D_ARRAY and the part of it used
+	struct TextureSlot
+	{
+		unsigned int			array = 0;		// 0 when the texture is not packed
+		int						layer = 0;
+		float					rect[4] = { 0.f, 0.f, 1.f, 1.f };	// uv offset and scale in the layer
+	};
+
+	// shared reference to a registered texture, the texture cannot be evicted while a handle holds it
+	class TextureHandle
+	{
+	public:
+		TextureHandle() = default;
+		TextureHandle(const TextureHandle& other);
+		~TextureHandle();
+
+		void					operator=(const TextureHandle& other);
+
+		unsigned int			id() const;
+		TextureSlot				slot() const;
+		inline bool				valid() const { return entry != nullptr; }
+
+	private:
+		friend class TextureRegistry;
+		friend class TexturePacker;
+
+		struct Entry;
+		TextureHandle(Entry* entry);
+
+		Entry*					entry = nullptr;
+	};
+
+	struct TextureHandle::Entry
+	{
+		std::string				path;
+		std::string				file;
+		unsigned int			texture = 0;
+		size_t					bytes = 0;
+		unsigned int			refCount = 0;
+		unsigned long long		lastUsed = 0;
+		bool					streaming = true;	// placeholder bound, the decoded image is still to come
+		TextureSlot				slot;
+
+		// full image, known once decoded, of which the GL texture holds the levels from residentLevel
+		int						width = 0;
+		int						height = 0;
+		int						levels = 0;
+		int						channels = 0;
+		int						residentLevel = 0;
+
+		float					coverage = 0.f;		// screen pixels of the closest object using it
+		unsigned long long		coverageFrame = 0;
+		unsigned long long		detailFrame = 0;	// last frame its finest resident level was needed
+	};
+
+	// textures by canonical path with their resident size, unreferenced ones are kept
+	// for reuse and evicted least recently used first once over the budget.
+	// Only the mip levels needed by the objects drawn are resident: coarser ones are dropped a while
+	// after the objects move away, finer ones decoded again when they come closer (GL thread only)
+	class TextureRegistry
+	{
+	private:
+		TextureRegistry() = default;
+
+	public:
+		static TextureRegistry& getInstance()
+		{
+			static TextureRegistry instance;
+
+			return instance;
+		}
+
+		TextureRegistry(const TextureRegistry& other) = delete;
+		void					operator=(const TextureRegistry& other) = delete;
+
+		TextureHandle			acquire(const std::string& textureFile);
+
+		// the object using the texture covers that many pixels of the screen this frame
+		void					requestDetail(const TextureHandle& handle, float pixels);
+
+		// finest level of the decoded image to upload, then called by the streamer once it replaced the previous one
+		int						firstResidentLevel(unsigned int texture, const TextureImage& image);
+		void					setResident(unsigned int texture, const TextureImage& image, int firstLevel);
+		void					cancelStreaming(unsigned int texture);
+
+		// decodes a registered file again into the same texture, the handles keep pointing to it.
+		// False when the file is not registered
+		bool					reload(const std::string& textureFile);
+
+		// evicts what is over the budget, packs the referenced textures again once the streamer is idle
+		// and one of them changed (mip levels once they have settled), then writes the statistics line of the frame
+		void					endFrame();
+		void					showImGuiControls();
+
+		static size_t			budget;			// bytes
+		static bool				csvEnabled;
+
+		static bool				mipStreaming;
+		static float			mipBias;			// levels added to the needed one, negative for sharper textures
+		static int				unseenSize;			// texels kept by the textures of the objects not drawn
+		static unsigned int		mipDropDelay;		// frames a finer level stays resident once unneeded
+		static unsigned int		mipRequestsPerFrame;
+		static unsigned int		repackDelay;		// frames without mip changes before the packed copies are rebuilt
+
+		size_t					mipStreams = 0;
+		size_t					mipTrims = 0;
+
+		size_t					residentBytes = 0;
+		size_t					hits = 0;
+		size_t					misses = 0;
+		size_t					evictions = 0;
+
+	private:
+		friend class TextureHandle;
+
+		TextureHandle::Entry*	find(unsigned int texture);
+		void					release(TextureHandle::Entry* entry);
+		void					evict();
+		void					streamMips();
+		void					trim(TextureHandle::Entry& entry, int level);
+		int						neededLevel(const TextureHandle::Entry& entry) const;
+		void					pack();
+		void					writeCsv();
+
+		std::map<std::string, TextureHandle::Entry>	entries;
+		std::ofstream			csv;
+		unsigned long long		frame = 0;
+		bool					overBudgetReported = false;
+		bool					packingDirty = false;
+		bool					residencyDirty = false;		// mip levels changed, only their textures were unpacked
+		unsigned long long		residencyFrame = 0;			// frame of the last mip change
+		bool					packingEnabled = false;		// state of TexturePacker::enabled at the last pack
+		int						budgetBias = 0;				// levels dropped from every texture while over the budget
+	};
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "core/datastructure/boundedqueue.hpp"
+#include "resources/texture.hpp"
+
+namespace Resources
+{
+	// decodes textures and builds their mip chain on the thread pool while a 1x1 placeholder is bound to their GL name,
+	// the main loop uploads the decoded images under a per frame time budget. At most queueCapacity images are
+	// decoding or waiting for their upload, the other requests wait on the GL thread so no worker ever blocks
+	class TextureStreamer
+	{
+	private:
+		TextureStreamer();
+
+	public:
+		static TextureStreamer& getInstance()
+		{
+			static TextureStreamer instance;
+
+			return instance;
+		}
+
+		~TextureStreamer();
+
+		TextureStreamer(const TextureStreamer& other) = delete;
+		void					operator=(const TextureStreamer& other) = delete;
+
+		// returns the GL texture at once, it holds the placeholder until its upload (GL thread only)
+		unsigned int			request(const std::string& textureFile);
+
+		// decodes the file again into an existing texture, which keeps its image until the upload,
+		// also used to bring back the finer levels of a texture trimmed by the registry (GL thread only)
+		void					reload(const std::string& textureFile, unsigned int texture);
+
+		// uploads decoded images until the budget is spent, at least one per call, then starts the waiting
+		// decodes (GL thread only)
+		void					processUploads();
+
+		inline size_t			pendingCount() const { return state->pending.load(); }
+
+		static float			uploadBudget;		// milliseconds per frame
+		static size_t			queueCapacity;
+
+	private:
+		struct Request
+		{
+			std::string			file;
+			unsigned int		texture = 0;
+			bool				reload = false;
+		};
+
+		struct DecodedImage
+		{
+			std::string			file;
+			unsigned int		texture = 0;
+			TextureImage		image;
+			bool				reload = false;
+		};
+
+		// shared with the decode jobs, which may outlive the streamer at exit
+		struct State
+		{
+			State(size_t capacity) : decoded(capacity) {}
+
+			Core::DataStructure::BoundedQueue<DecodedImage>	decoded;
+			std::atomic<size_t>								pending{ 0 };
+		};
+
+		void					submit(const std::string& textureFile, unsigned int texture, bool reload);
+		void					startDecodes();
+
+		std::shared_ptr<State>	state;
+		std::deque<Request>		waiting;
+		size_t					decoding = 0;		// started and not uploaded yet, never above the queue capacity
+	};
+}
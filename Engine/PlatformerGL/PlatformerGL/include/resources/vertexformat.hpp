@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "core/core.hpp"
+#include "core/maths/maths.hpp"
+
+namespace Resources
+{
+	struct VertexAttribute
+	{
+		GLuint					location;
+		GLint					size;
+		GLenum					type;
+		GLboolean				normalized;
+		GLuint					offset;
+	};
+
+	// layout of one vertex in a GPU buffer, the attribute setup of the meshes is driven by it
+	struct VertexFormat
+	{
+		GLsizei							stride = 0;
+		std::vector<VertexAttribute>	attributes;
+
+		// points the attributes at the bound array buffer of the bound VAO
+		void					apply() const;
+
+		// normalized int16 positions in the mesh bounds, octahedral normals and half float uvs (16 bytes)
+		static const VertexFormat&	compact();
+		// same with float positions (20 bytes)
+		static const VertexFormat&	compactFloatPositions();
+	};
+
+	struct CompactVertex
+	{
+		int16_t					position[4];	// the 4th is padding
+		int16_t					normal[2];
+		uint16_t				texCoord[2];
+	};
+
+	struct CompactFloatVertex
+	{
+		float					position[3];
+		int16_t					normal[2];
+		uint16_t				texCoord[2];
+	};
+
+	// vertex and index data ready for the buffers, the shaders get
+	// the position back with position * positionScale + positionOffset
+	struct PackedMesh
+	{
+		const VertexFormat*			format = nullptr;
+		std::vector<unsigned char>	vertexData;
+		std::vector<unsigned char>	indexData;
+		GLenum						indexType = GL_UNSIGNED_INT;
+		Core::Maths::vec3			positionScale = { 1.f, 1.f, 1.f };
+		Core::Maths::vec3			positionOffset = { 0.f, 0.f, 0.f };
+	};
+
+	// largest differences between the source vertices and what the shaders decode from the packed ones
+	struct RoundTripError
+	{
+		float					position = 0.f;		// world units
+		float					normal = 0.f;		// degrees
+		float					texCoord = 0.f;
+	};
+
+	class VertexPacker
+	{
+	public:
+		VertexPacker() = delete;
+		VertexPacker(const VertexPacker& other) = delete;
+		void					operator=(const VertexPacker& other) = delete;
+
+		// indices are 16 bit when the mesh has fewer than 65536 vertices
+		static void				pack(const std::vector<Core::rdrVertex>& vertices, const std::vector<unsigned int>& indices, PackedMesh& packed);
+		static RoundTripError	roundTripError(const std::vector<Core::rdrVertex>& vertices, const PackedMesh& packed);
+
+		static bool				quantizePositions;
+		static bool				reportError;
+	};
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "core/maths/maths.hpp"
+#include "resources/sceneparser.hpp"
+
+namespace Resources
+{
+	class Scene;
+	class ResourcesManager;
+
+	// streamed level: the enemies and platforms of a scene are split into square cells of the XZ plane, each
+	// stored as a snapshot in Bin/scenes/<scene>.world/. The cells around the first player are read on the
+	// thread pool and built on the GL thread, their objects joining the ones the players collide with.
+	// The players, camera and lights stay resident
+	class WorldStreamer
+	{
+	public:
+		WorldStreamer() = default;
+
+		WorldStreamer(const WorldStreamer& other) = delete;
+		void				operator=(const WorldStreamer& other) = delete;
+		~WorldStreamer();
+
+		// splits the scene file into its cells when they are missing, older than the file or of another size
+		static bool			prepare(const std::string& sceneName);
+		static bool			build(const std::string& sceneName);
+
+		// resident records of the scene, the saves are loaded whole and filtered
+		static bool			loadResident(const std::string& sceneName, SceneData& data);
+		static void			keepResident(SceneData& data);
+
+		// appends the enemies and platforms of the scene file to the resident records of a streamed save,
+		// for a game continued without streaming. They are back at their starting place, like the cells
+		static bool			addWorld(const std::string& sceneName, SceneData& data);
+
+		bool				open(const std::string& sceneName);
+
+		// once per frame on the GL thread, before the scene is updated
+		void				update(Scene& scene, ResourcesManager& rm);
+
+		// builds every cell in reach before the first frame
+		void				preload(Scene& scene, ResourcesManager& rm);
+
+		// removes the streamed objects from the scene, it may be destroyed afterwards
+		void				close(Scene& scene);
+
+		inline size_t		getCellCount() const { return cells.size(); }
+		inline size_t		getResidentCount() const { return residentCells; }
+		inline size_t		getLoadingCount() const { return loadingCells; }
+		inline size_t		getObjectCount() const { return streamedObjects; }
+
+		static std::string	directory(const std::string& sceneName);
+
+		static bool			enabled;
+		static float		cellSize;			// world units, used when the cells are built
+		static float		radius;				// cells closer to the player are loaded
+		static float		evictMargin;		// added to the radius before a cell is evicted
+		static size_t		maxLoads;			// cells read at the same time
+		static size_t		buildsPerFrame;		// cells turned into game objects per frame
+
+	private:
+		using CellKey = std::pair<int, int>;
+
+		struct Chunk
+		{
+			std::future<SceneData>	pending;
+			std::unique_ptr<Scene>	objects;	// enemies and platforms of the cell
+		};
+
+		float				distance(const CellKey& cell, const Core::Maths::vec3& position) const;
+		void				instantiate(const CellKey& cell, SceneData& data, Scene& scene, ResourcesManager& rm, Chunk& chunk);
+		void				evict(Scene& scene, Chunk& chunk);
+
+		std::string			sceneName;
+		float				size = 0.f;
+		std::map<CellKey, size_t>	cells;		// models of every non empty cell
+		std::map<CellKey, Chunk>	chunks;		// loading or resident
+		size_t				residentCells = 0;
+		size_t				loadingCells = 0;
+		size_t				streamedObjects = 0;
+	};
+}
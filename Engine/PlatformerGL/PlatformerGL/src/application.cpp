@@ -9,6 +9,18 @@
 #include "application.hpp"
 #include "core/debug/log.hpp"
 #include "core/debug/assertion.hpp"
+#include "core/debug/loadprofiler.hpp"
+#include "core/io/assetpack.hpp"
+#include "resources/objparser.hpp"
+#include "resources/meshcache.hpp"
+#include "resources/meshcodec.hpp"
+#include "resources/meshoptimizer.hpp"
+#include "resources/meshsimplifier.hpp"
+#include "resources/scenesnapshot.hpp"
+#include "resources/texturestreamer.hpp"
+#include "resources/textureregistry.hpp"
+#include "resources/vertexformat.hpp"
+#include "resources/worldstreamer.hpp"
 #include "time.hpp"
 
 Application::Application(GLFWframebuffersizefun callback)
@@ -135,6 +147,11 @@ void Application::gameLoop()
 
 		processInput();
 
+		graph.reloadChangedAssets();
+		Resources::TextureStreamer::getInstance().processUploads();
+		Resources::TextureRegistry::getInstance().endFrame();
+		Core::Debug::LoadProfiler::getInstance().update(Resources::TextureStreamer::getInstance().pendingCount());
+
 		switch (gs)
 		{
 		case GameState::INMENU:
@@ -171,6 +188,8 @@ void Application::render()
 	glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
 	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 		
+	graph.streamWorld(currScene);
+
 	Resources::Scene& scene = graph.getScene(currScene);
 	scene.process(window, inputs, playerInputs, gameMode);
 
@@ -269,6 +288,42 @@ void Application::showImGuiControls()
 			{
 				ImGui::Checkbox("Logs Enabled", &Core::Debug::Log::enabled);
 				ImGui::Checkbox("Asserts Enabled", &Core::Debug::Assertion::enabled);
+				ImGui::Checkbox("Load profiler", &Core::Debug::LoadProfiler::enabled);
+				ImGui::Checkbox("Parallel OBJ parsing", &Resources::ObjParser::parallelEnabled);
+				ImGui::Checkbox("Baked mesh cache", &Resources::MeshCache::enabled);
+				ImGui::Checkbox("Hot reload assets", &Resources::ResourcesManager::hotReload);
+				ImGui::Checkbox("Asset pack", &Core::IO::AssetPack::enabled);
+				ImGui::SameLine();
+				ImGui::Text("%d entries", int(Core::IO::AssetPack::getInstance().getEntryCount()));
+				ImGui::Checkbox("Optimize imported meshes", &Resources::MeshOptimizer::enabled);
+				ImGui::Checkbox("Keep mesh data on CPU", &Resources::Mesh::keepCpuData);
+				ImGui::Checkbox("Quantize mesh positions", &Resources::VertexPacker::quantizePositions);
+				ImGui::Checkbox("Report vertex quantization error", &Resources::VertexPacker::reportError);
+				ImGui::Checkbox("Generate LODs on import", &Resources::MeshSimplifier::enabled);
+				ImGui::Checkbox("LOD selection", &Resources::Scene::lodEnabled);
+				ImGui::SliderFloat("LOD screen size", &Resources::Scene::lodThreshold, 0.05f, 1.f);
+				ImGui::SliderFloat("LOD hysteresis", &Resources::Scene::lodHysteresis, 0.f, 0.5f);
+				ImGui::SliderFloat("Texture upload budget (ms)", &Resources::TextureStreamer::uploadBudget, 0.1f, 16.f);
+				ImGui::Text("Textures streaming: %d", int(Resources::TextureStreamer::getInstance().pendingCount()));
+				Resources::TextureRegistry::getInstance().showImGuiControls();
+				if (ImGui::Button("Benchmark OBJ parser"))
+					Resources::ObjParser::benchmark("Assets/models/");
+				if (ImGui::Button("Benchmark mesh codec"))
+					Resources::MeshCodec::benchmark("Assets/models/");
+				ImGui::Checkbox("Compress scene snapshots", &Resources::SceneSnapshot::compressed);
+				if (ImGui::Button("Convert scenes to snapshots"))
+					graph.convertScenes(true);
+				ImGui::SameLine();
+				if (ImGui::Button("Convert saves to SCN"))
+					graph.convertScenes(false);
+				ImGui::Checkbox("Stream world (next load)", &Resources::WorldStreamer::enabled);
+				ImGui::SliderFloat("World cell size", &Resources::WorldStreamer::cellSize, 8.f, 256.f);
+				ImGui::SliderFloat("Stream radius", &Resources::WorldStreamer::radius, 8.f, 512.f);
+				if (const Resources::WorldStreamer* world = graph.getWorld(currScene))
+				{
+					ImGui::Text("World cells: %d of %d resident, %d loading | %d objects", int(world->getResidentCount()),
+						int(world->getCellCount()), int(world->getLoadingCount()), int(world->getObjectCount()));
+				}
 			}
 			ImGui::TreePop();
 		}
@@ -340,6 +395,16 @@ bool Application::getJumpInput()
 	return false;
 }
 
+// one save per press of F5
+bool Application::getSaveInput()
+{
+	auto newSaveState = glfwGetKey(window, GLFW_KEY_F5);
+	bool pressed = newSaveState == GLFW_PRESS && saveState == GLFW_RELEASE;
+
+	saveState = newSaveState;
+	return pressed;
+}
+
 void Application::updateCameraInputs()
 {
 	inputs.deltaX = mouseDeltaX;
@@ -369,7 +434,7 @@ void Application::processInput()
 			gs = GameState::INMENU;
 			Time::timeScale() = 0.f;
 		}
-		if (glfwGetKey(window, GLFW_KEY_F5))
+		if (getSaveInput())
 		{
 			graph.saveScenes();
 		}
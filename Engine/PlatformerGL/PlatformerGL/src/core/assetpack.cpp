@@ -0,0 +1,374 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include "core/io/assetpack.hpp"
+#include "core/io/compression.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Core::IO;
+
+std::string AssetPack::packFile = "Assets.pack";
+bool AssetPack::enabled = true;
+
+namespace
+{
+    const char packMagic[8] = { 'P', 'G', 'L', 'P', 'A', 'C', 'K', 0 };
+    constexpr uint32_t packVersion = 1;
+    constexpr uint64_t blobAlignment = 64;
+
+    constexpr uint32_t compressedFlag = 1;
+
+    // count items of itemSize bytes from offset stay within size, without the sum wrapping around
+    bool fits(uint64_t offset, uint64_t count, uint64_t itemSize, uint64_t size)
+    {
+        return offset <= size && count <= (size - offset) / itemSize;
+    }
+}
+
+struct AssetPack::Header
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    entryCount;
+    uint32_t    slotCount;      // power of two, open addressing on the path hash
+    uint32_t    padding;
+    uint64_t    entriesOffset;
+    uint64_t    slotsOffset;    // entry index + 1 per slot, 0 when empty
+    uint64_t    namesOffset;
+    uint64_t    namesSize;
+};
+
+struct AssetPack::Entry
+{
+    uint64_t    pathHash;
+    uint64_t    contentHash;
+    uint64_t    offset;
+    uint64_t    storedSize;
+    uint64_t    size;
+    uint32_t    nameOffset;
+    uint32_t    nameLength;
+    uint32_t    flags;
+    uint32_t    padding;
+};
+
+AssetPack::AssetPack()
+{
+    if (enabled)
+        mount(packFile);
+}
+
+bool AssetPack::mount(const std::string& packFile)
+{
+    unmount();
+
+    if (!file.open(packFile))
+        return false;
+
+    const char* data = file.data();
+    size_t size = file.size();
+
+    const Header* candidate = reinterpret_cast<const Header*>(data);
+    bool valid = size >= sizeof(Header) && std::memcmp(candidate->magic, packMagic, sizeof(packMagic)) == 0
+        && candidate->version == packVersion && candidate->slotCount > 0
+        && (candidate->slotCount & (candidate->slotCount - 1)) == 0
+        && fits(candidate->entriesOffset, candidate->entryCount, sizeof(Entry), size)
+        && fits(candidate->slotsOffset, candidate->slotCount, sizeof(uint32_t), size)
+        && fits(candidate->namesOffset, candidate->namesSize, 1, size);
+
+    // every entry is checked once here so reads can trust the table, a compressed size is bounded by
+    // what its stored bytes can decode to before read allocates for it
+    const Entry* candidateEntries = valid ? reinterpret_cast<const Entry*>(data + candidate->entriesOffset) : nullptr;
+    for (uint32_t i = 0; valid && i < candidate->entryCount; ++i)
+    {
+        const Entry& entry = candidateEntries[i];
+        valid = fits(entry.offset, entry.storedSize, 1, size)
+            && fits(entry.nameOffset, entry.nameLength, 1, candidate->namesSize)
+            && ((entry.flags & compressedFlag) != 0 ? entry.size <= entry.storedSize * Compression::maxRatio : entry.storedSize == entry.size);
+    }
+
+    if (!valid)
+    {
+        std::string statement = "Invalid asset pack ignored: " + packFile;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        file.close();
+        return false;
+    }
+
+    header = candidate;
+    entries = candidateEntries;
+    slots = reinterpret_cast<const uint32_t*>(data + header->slotsOffset);
+    names = data + header->namesOffset;
+    entryCount = header->entryCount;
+
+    std::string statement = "Asset pack mounted: " + packFile + " | " + std::to_string(entryCount) + " entries, "
+        + std::to_string(size / 1024) + " KB";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+
+    return true;
+}
+
+void AssetPack::unmount()
+{
+    file.close();
+    header = nullptr;
+    entries = nullptr;
+    slots = nullptr;
+    names = nullptr;
+    entryCount = 0;
+}
+
+std::string AssetPack::normalize(const std::string& path)
+{
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+uint64_t AssetPack::hash(const char* data, size_t size)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= uint64_t(static_cast<unsigned char>(data[i]));
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+const AssetPack::Entry* AssetPack::find(const std::string& path) const
+{
+    if (!enabled || entryCount == 0)
+        return nullptr;
+
+    std::string name = normalize(path);
+    {
+        std::lock_guard<std::mutex> lock(invalidatedMutex);
+        if (!invalidated.empty() && invalidated.count(name) > 0)
+            return nullptr;
+    }
+
+    uint64_t pathHash = hash(name.data(), name.size());
+    uint32_t mask = header->slotCount - 1;
+    for (uint32_t probe = 0, slot = uint32_t(pathHash) & mask; probe <= mask; ++probe, slot = (slot + 1) & mask)
+    {
+        uint32_t index = slots[slot];
+        if (index == 0 || index > entryCount)
+            return nullptr;
+
+        const Entry& entry = entries[index - 1];
+        if (entry.pathHash == pathHash && entry.nameLength == name.size()
+            && std::memcmp(names + entry.nameOffset, name.data(), name.size()) == 0)
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+bool AssetPack::contains(const std::string& path) const
+{
+    return find(path) != nullptr;
+}
+
+bool AssetPack::stat(const std::string& path, uint64_t& size, uint64_t& contentHash) const
+{
+    const Entry* entry = find(path);
+    if (!entry)
+        return false;
+
+    size = entry->size;
+    contentHash = entry->contentHash;
+    return true;
+}
+
+bool AssetPack::read(const std::string& path, const char*& data, size_t& size, std::vector<char>& buffer) const
+{
+    const Entry* entry = find(path);
+    if (!entry)
+        return false;
+
+    const char* stored = file.data() + entry->offset;
+    size = size_t(entry->size);
+
+    if (!(entry->flags & compressedFlag))
+    {
+        data = stored;
+        return true;
+    }
+
+    buffer.resize(size);
+    if (!Compression::decompress(stored, size_t(entry->storedSize), buffer.data(), size))
+    {
+        std::string statement = "Corrupt asset pack entry: " + path;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    data = buffer.data();
+    return true;
+}
+
+void AssetPack::invalidate(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(invalidatedMutex);
+    invalidated.insert(normalize(path));
+}
+
+bool AssetPack::build(const std::vector<Source>& sources, const std::string& packFile, bool compress, BuildStats& stats)
+{
+    std::ofstream out(packFile, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    // the header is written again at the end, once the offsets are known
+    Header header = {};
+    std::memcpy(header.magic, packMagic, sizeof(packMagic));
+    header.version = packVersion;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t offset = sizeof(header);
+    auto align = [&]()
+    {
+        static const char zeros[blobAlignment] = {};
+        uint64_t padding = (blobAlignment - offset % blobAlignment) % blobAlignment;
+        out.write(zeros, std::streamsize(padding));
+        offset += padding;
+    };
+
+    std::vector<Entry> packEntries;
+    std::string packNames;
+    std::set<uint64_t> pathHashes;
+
+    // blobs already written by content hash, the bytes are compared against their source to rule out collisions
+    std::map<uint64_t, std::vector<size_t>> blobsByHash;
+    std::vector<char> compressed;
+
+    stats = BuildStats();
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        const Source& source = sources[i];
+        std::string name = normalize(source.path);
+
+        MappedFile input;
+        if (!input.open(source.file))
+            return false;
+
+        Entry entry = {};
+        entry.pathHash = hash(name.data(), name.size());
+        entry.contentHash = hash(input.data(), input.size());
+        entry.size = input.size();
+        entry.nameOffset = uint32_t(packNames.size());
+        entry.nameLength = uint32_t(name.size());
+
+        // two names with the same hash could not be told apart by the table
+        if (!pathHashes.insert(entry.pathHash).second)
+            return false;
+
+        packNames += name;
+        ++stats.files;
+        stats.inputBytes += input.size();
+
+        const Entry* duplicate = nullptr;
+        for (size_t candidate : blobsByHash[entry.contentHash])
+        {
+            MappedFile other;
+            if (packEntries[candidate].size == entry.size && other.open(sources[candidate].file) && other.size() == input.size()
+                && (input.size() == 0 || std::memcmp(other.data(), input.data(), input.size()) == 0))
+            {
+                duplicate = &packEntries[candidate];
+                break;
+            }
+        }
+
+        if (duplicate)
+        {
+            entry.offset = duplicate->offset;
+            entry.storedSize = duplicate->storedSize;
+            entry.flags = duplicate->flags;
+            packEntries.push_back(entry);
+            continue;
+        }
+
+        const char* blob = input.data();
+        size_t blobSize = input.size();
+        if (compress && input.size() > 0)
+        {
+            Compression::compress(input.data(), input.size(), compressed);
+            if (compressed.size() <= input.size() - input.size() / 8)
+            {
+                blob = compressed.data();
+                blobSize = compressed.size();
+                entry.flags |= compressedFlag;
+                ++stats.compressed;
+            }
+        }
+
+        align();
+        entry.offset = offset;
+        entry.storedSize = blobSize;
+        out.write(blob, std::streamsize(blobSize));
+        offset += blobSize;
+
+        blobsByHash[entry.contentHash].push_back(packEntries.size());
+        packEntries.push_back(entry);
+        ++stats.blobs;
+    }
+
+    header.entryCount = uint32_t(packEntries.size());
+    header.slotCount = 1;
+    while (header.slotCount < packEntries.size() * 2)
+        header.slotCount <<= 1;
+
+    std::vector<uint32_t> packSlots(header.slotCount, 0);
+    for (size_t i = 0; i < packEntries.size(); ++i)
+    {
+        uint32_t mask = header.slotCount - 1;
+        uint32_t slot = uint32_t(packEntries[i].pathHash) & mask;
+        while (packSlots[slot] != 0)
+            slot = (slot + 1) & mask;
+        packSlots[slot] = uint32_t(i + 1);
+    }
+
+    align();
+    header.entriesOffset = offset;
+    out.write(reinterpret_cast<const char*>(packEntries.data()), std::streamsize(packEntries.size() * sizeof(Entry)));
+    offset += packEntries.size() * sizeof(Entry);
+
+    header.slotsOffset = offset;
+    out.write(reinterpret_cast<const char*>(packSlots.data()), std::streamsize(packSlots.size() * sizeof(uint32_t)));
+    offset += packSlots.size() * sizeof(uint32_t);
+
+    header.namesOffset = offset;
+    header.namesSize = packNames.size();
+    out.write(packNames.data(), std::streamsize(packNames.size()));
+    offset += packNames.size();
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    stats.packBytes = offset;
+    return out.good();
+}
+
+AssetFile::AssetFile(const std::string& path)
+{
+    open(path);
+}
+
+bool AssetFile::open(const std::string& path)
+{
+    loose.close();
+    buffer.clear();
+    bytes = nullptr;
+    length = 0;
+
+    packed = AssetPack::getInstance().read(path, bytes, length, buffer);
+    opened = packed || loose.open(path);
+    if (opened && !packed)
+    {
+        bytes = loose.data();
+        length = loose.size();
+    }
+
+    return opened;
+}
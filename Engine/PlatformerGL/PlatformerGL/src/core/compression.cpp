@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "core/io/compression.hpp"
+
+using namespace Core::IO;
+
+namespace
+{
+    constexpr size_t minMatch = 4;
+    constexpr size_t maxOffset = 65535;
+    constexpr int hashBits = 16;
+
+    // the block ends with literals: no match starts in the last 12 bytes nor covers the last 5
+    constexpr size_t matchStartMargin = 12;
+    constexpr size_t matchEndMargin = 5;
+
+    inline uint32_t read32(const unsigned char* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t hashSequence(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - hashBits);
+    }
+
+    void writeLength(std::vector<char>& compressed, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+            compressed.push_back(char(255));
+        compressed.push_back(char(length));
+    }
+
+    bool readLength(const unsigned char*& in, const unsigned char* end, size_t& length)
+    {
+        unsigned char byte;
+        do
+        {
+            if (in >= end)
+                return false;
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+
+        return true;
+    }
+
+    void writeSequence(std::vector<char>& compressed, const unsigned char* literals, size_t literalCount,
+        size_t offset, size_t matchLength)
+    {
+        size_t matchCode = matchLength - minMatch;
+        unsigned char token = static_cast<unsigned char>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+        compressed.push_back(char(token));
+
+        if (literalCount >= 15)
+            writeLength(compressed, literalCount - 15);
+        compressed.insert(compressed.end(), literals, literals + literalCount);
+
+        compressed.push_back(char(offset & 0xff));
+        compressed.push_back(char(offset >> 8));
+
+        if (matchCode >= 15)
+            writeLength(compressed, matchCode - 15);
+    }
+
+    void writeLastLiterals(std::vector<char>& compressed, const unsigned char* literals, size_t literalCount)
+    {
+        compressed.push_back(char(std::min<size_t>(literalCount, 15) << 4));
+        if (literalCount >= 15)
+            writeLength(compressed, literalCount - 15);
+        compressed.insert(compressed.end(), literals, literals + literalCount);
+    }
+}
+
+void Compression::compress(const char* data, size_t size, std::vector<char>& compressed)
+{
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(data);
+
+    compressed.clear();
+    compressed.reserve(size + size / 255 + 16);
+
+    size_t anchor = 0;
+    if (size > matchStartMargin)
+    {
+        // last position seen for each hashed 4 byte sequence, candidates are checked before use
+        std::vector<uint32_t> table(size_t(1) << hashBits, 0);
+
+        size_t limit = size - matchStartMargin;
+        size_t position = 0;
+        while (position < limit)
+        {
+            uint32_t sequence = read32(src + position);
+            uint32_t& slot = table[hashSequence(sequence)];
+            size_t candidate = slot;
+            slot = uint32_t(position);
+
+            if (candidate >= position || position - candidate > maxOffset || read32(src + candidate) != sequence)
+            {
+                ++position;
+                continue;
+            }
+
+            size_t length = minMatch;
+            size_t maxLength = size - matchEndMargin - position;
+            while (length < maxLength && src[candidate + length] == src[position + length])
+                ++length;
+
+            writeSequence(compressed, src + anchor, position - anchor, position - candidate, length);
+
+            position += length;
+            anchor = position;
+
+            // keeps the table fresh inside long matches at little cost
+            if (position - 2 < limit)
+                table[hashSequence(read32(src + position - 2))] = uint32_t(position - 2);
+        }
+    }
+
+    writeLastLiterals(compressed, src + anchor, size - anchor);
+}
+
+bool Compression::decompress(const char* compressed, size_t compressedSize, char* data, size_t size)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(compressed);
+    const unsigned char* inEnd = in + compressedSize;
+    unsigned char* outBegin = reinterpret_cast<unsigned char*>(data);
+    unsigned char* out = outBegin;
+    unsigned char* outEnd = out + size;
+
+    while (in < inEnd)
+    {
+        unsigned char token = *in++;
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(in, inEnd, literalCount))
+            return false;
+        if (literalCount > size_t(inEnd - in) || literalCount > size_t(outEnd - out))
+            return false;
+
+        // short runs are copied with one fixed size copy while both buffers have room for it
+        if (literalCount <= 16 && inEnd - in >= 16 && outEnd - out >= 16)
+            std::memcpy(out, in, 16);
+        else
+            std::memcpy(out, in, literalCount);
+        in += literalCount;
+        out += literalCount;
+
+        // the last sequence only has literals
+        if (in == inEnd)
+            break;
+
+        if (inEnd - in < 2)
+            return false;
+        size_t offset = size_t(in[0]) | (size_t(in[1]) << 8);
+        in += 2;
+        if (offset == 0 || offset > size_t(out - outBegin))
+            return false;
+
+        size_t length = token & 15;
+        if (length == 15 && !readLength(in, inEnd, length))
+            return false;
+        length += minMatch;
+        if (length > size_t(outEnd - out))
+            return false;
+
+        const unsigned char* match = out - offset;
+        unsigned char* matchEnd = out + length;
+        if (offset >= 8 && size_t(outEnd - out) >= length + 8)
+        {
+            // chunks of 8 never read bytes not written yet, the last one may write past the match
+            for (; out < matchEnd; out += 8, match += 8)
+                std::memcpy(out, match, 8);
+            out = matchEnd;
+        }
+        else
+        {
+            // overlapping match: a repeating pattern
+            while (out < matchEnd)
+                *out++ = *match++;
+        }
+    }
+
+    return out == outEnd;
+}
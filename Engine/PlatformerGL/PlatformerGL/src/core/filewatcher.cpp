@@ -0,0 +1,146 @@
+#include <set>
+
+#include "core/io/filewatcher.hpp"
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/inotify.h>
+#endif
+
+using namespace Core::IO;
+
+float FileWatcher::pollInterval = 0.5f;
+
+namespace
+{
+    std::string normalize(const std::filesystem::path& path)
+    {
+        std::string normalized = path.lexically_normal().generic_string();
+        return normalized.empty() ? "." : normalized;
+    }
+}
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher()
+{
+    inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (inotifyDescriptor >= 0)
+        ::close(inotifyDescriptor);
+}
+
+void FileWatcher::watch(const std::string& path)
+{
+    std::string file = normalize(path);
+    if (!files.emplace(file, path).second || inotifyDescriptor < 0)
+        return;
+
+    // editors often write a new file and rename it over the old one: the directory is watched, not the file
+    std::string directory = normalize(std::filesystem::path(file).parent_path());
+    if (directoryWatches.count(directory) > 0)
+        return;
+
+    int descriptor = inotify_add_watch(inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (descriptor < 0)
+        return;
+
+    directories[descriptor] = directory;
+    directoryWatches[directory] = descriptor;
+}
+
+void FileWatcher::clear()
+{
+    for (const auto& it : directories)
+        inotify_rm_watch(inotifyDescriptor, it.first);
+
+    directories.clear();
+    directoryWatches.clear();
+    files.clear();
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+    std::set<std::string> changed;
+
+    alignas(struct inotify_event) char buffer[4096];
+    while (inotifyDescriptor >= 0)
+    {
+        ssize_t length = ::read(inotifyDescriptor, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (char* cursor = buffer; cursor < buffer + length; )
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(cursor);
+            cursor += sizeof(struct inotify_event) + event->len;
+
+            auto directory = directories.find(event->wd);
+            if (directory == directories.end() || event->len == 0)
+                continue;
+
+            auto file = files.find(normalize(std::filesystem::path(directory->second) / event->name));
+            if (file != files.end())
+                changed.insert(file->second);
+        }
+    }
+
+    return std::vector<std::string>(changed.begin(), changed.end());
+}
+
+#else
+
+FileWatcher::FileWatcher()
+    : lastScan(std::chrono::steady_clock::now())
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+void FileWatcher::watch(const std::string& path)
+{
+    std::string file = normalize(path);
+    if (!files.emplace(file, path).second)
+        return;
+
+    std::error_code error;
+    writeTimes[file] = std::filesystem::last_write_time(file, error);
+}
+
+void FileWatcher::clear()
+{
+    files.clear();
+    writeTimes.clear();
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+    std::vector<std::string> changed;
+
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<float>(now - lastScan).count() < pollInterval)
+        return changed;
+    lastScan = now;
+
+    for (auto& it : writeTimes)
+    {
+        // a file being replaced may be missing for a moment, it is compared again on the next scan
+        std::error_code error;
+        std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(it.first, error);
+        if (error || writeTime == it.second)
+            continue;
+
+        it.second = writeTime;
+        changed.push_back(files[it.first]);
+    }
+
+    return changed;
+}
+
+#endif
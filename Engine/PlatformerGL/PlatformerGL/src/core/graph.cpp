@@ -1,9 +1,18 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include "core/datastructure/graph.hpp"
 #include "core/debug/log.hpp"
 #include "core/debug/assertion.hpp"
+#include "core/debug/loadprofiler.hpp"
+#include "core/io/assetpack.hpp"
+#include "core/datastructure/threadpool.hpp"
+#include "resources/scenesnapshot.hpp"
+#include "resources/texturestreamer.hpp"
 
 #include "lowrenderer/directionallight.hpp"
 #include "lowrenderer/spotlight.hpp"
@@ -17,60 +26,116 @@
 
 using namespace Core::DataStructure;
 
+Graph::~Graph()
+{
+    // the GL context may be gone, the save job does not need the uploads to end
+    waitForSave(false);
+    unloadScenes();
+}
+
 void Graph::loadScenes()
 {
 	std::vector<std::string> sceneList;
+	auto start = std::chrono::steady_clock::now();
+    waitForSave();
+    Core::Debug::LoadProfiler::getInstance().begin("loadScenes");
+
 	parseSceneList(sceneList, "Bin/scenes/scene_list.txt");
 	for (std::string& scene : sceneList)
 	{
         rm.addResource(static_cast<int>(Resources::ResourceType::SCENE), scene);
-        loadScene(false);
+        loadScene(rm.scenes.back(), false);
 	}
 
     {
-        std::string statement = "Scenes Loaded: " + std::to_string(rm.scenes.size());
+        std::string statement = "Scenes Loaded: " + std::to_string(rm.scenes.size()) + " in "
+            + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()) + " ms";
         Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
         for (Resources::Scene& scene : rm.scenes)
         {
             scene.debug();
         }
     }
+
+    Core::Debug::LoadProfiler::getInstance().finish(Resources::TextureStreamer::getInstance().pendingCount());
 }
 
 void Graph::unloadScenes()
 {
+    waitForSave();
+
+    for (Resources::Scene& scene : scenes)
+    {
+        auto world = worlds.find(scene.name);
+        if (world != worlds.end())
+            world->second.close(scene);
+    }
+
     rm.scenes.clear();
     scenes.clear();
+    journals.clear();
+    worlds.clear();
 
     scenesLoaded = false;
 }
 
 void Graph::saveScenes()
 {
-    saveScene();
+    if (pendingSave.valid() && pendingSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        Core::Debug::Log::print("Save skipped, the previous one is still being written", Core::Debug::LogType::WARNING);
+        return;
+    }
+
+    // only the live values are copied on this thread, the records stay shared with the journals
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::pair<Resources::SceneJournal*, Resources::SceneState>> saves;
+    for (const Resources::Scene& scene : scenes)
+    {
+        auto found = journals.find(scene.name);
+        if (found == journals.end() || !found->second.getSource())
+            continue;
+
+        saves.emplace_back(&found->second, Resources::SceneState());
+        captureScene(scene, *found->second.getSource(), saves.back().second);
+    }
+
+    pendingSave = ThreadPool::getInstance().submit([saves = std::move(saves)]()
+    {
+        for (const auto& save : saves)
+            save.first->commit(save.second);
+    });
+
+    std::string statement = "Save started in " + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+}
+
+void Graph::waitForSave(bool uploading)
+{
+    if (!pendingSave.valid())
+        return;
+
+    while (pendingSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        if (uploading)
+            Resources::TextureStreamer::getInstance().processUploads();
+        pendingSave.wait_for(std::chrono::milliseconds(1));
+    }
 }
 
 bool Graph::hasSavedScene()
 {
+    waitForSave();
+
     std::vector<std::string> sceneList;
     parseSceneList(sceneList, "Bin/scenes/scene_list.txt");
     for (std::string& scene : sceneList)
     {
-        //looking for a scene with "save_"
-        std::string path = "Bin/scenes/save_" + scene;
-        std::ifstream savedFile;
-        savedFile.open(path);
-
-        if (savedFile.is_open())
-        {
-            savedFile.close();
-            return true;
-        }
-        else
-        {
-            savedFile.close();
-            return false;
-        }
+        // snapshot of either kind, or text save of the previous versions
+        std::error_code error;
+        return std::filesystem::exists(Resources::SceneSnapshot::savePath(scene), error)
+            || std::filesystem::exists(Resources::SceneSnapshot::savePath(scene, true), error)
+            || std::filesystem::exists("Bin/scenes/save_" + scene, error);
     }
     return false;
 }
@@ -78,28 +143,94 @@ bool Graph::hasSavedScene()
 void Graph::loadSavedScene()
 {
     std::vector<std::string> sceneList;
+    auto start = std::chrono::steady_clock::now();
+    waitForSave();
+    Core::Debug::LoadProfiler::getInstance().begin("loadSavedScene");
+
     parseSceneList(sceneList, "Bin/scenes/scene_list.txt");
     for (std::string& scene : sceneList)
     {
         rm.addResource(static_cast<int>(Resources::ResourceType::SCENE), scene);
-        loadScene(true);
+        loadScene(rm.scenes.back(), true);
     }
 
     {
-        std::string statement = "Scenes Loaded: " + std::to_string(rm.scenes.size());
+        std::string statement = "Scenes Loaded: " + std::to_string(rm.scenes.size()) + " in "
+            + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()) + " ms";
         Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
         for (Resources::Scene& scene : rm.scenes)
         {
             scene.debug();
         }
     }
+
+    Core::Debug::LoadProfiler::getInstance().finish(Resources::TextureStreamer::getInstance().pendingCount());
+}
+
+void Graph::reloadChangedAssets()
+{
+    rm.reloadChanged(scenes);
+}
+
+void Graph::streamWorld(int index)
+{
+    if (index < 0 || size_t(index) >= scenes.size())
+        return;
+
+    auto world = worlds.find(scenes[index].name);
+    if (world != worlds.end())
+        world->second.update(scenes[index], rm);
+}
+
+const Resources::WorldStreamer* Graph::getWorld(int index) const
+{
+    if (index < 0 || size_t(index) >= scenes.size())
+        return nullptr;
+
+    auto world = worlds.find(scenes[index].name);
+    return world != worlds.end() ? &world->second : nullptr;
+}
+
+void Graph::convertScenes(bool toSnapshots)
+{
+    waitForSave();
+
+    std::vector<std::string> sceneList;
+    parseSceneList(sceneList, "Bin/scenes/scene_list.txt");
+    for (const std::string& scene : sceneList)
+    {
+        std::string stem = std::filesystem::path(scene).stem().string();
+        if (toSnapshots)
+        {
+            Resources::SceneSnapshot::convert("Bin/scenes/" + scene, "Bin/scenes/" + stem + Resources::SceneSnapshot::extension);
+            continue;
+        }
+
+        // the saves written since the snapshot are part of it
+        Resources::SceneData data;
+        if (!Resources::SceneSnapshot::load(Resources::SceneSnapshot::savePath(scene), data))
+        {
+            std::string statement = "Scene conversion: unable to read " + Resources::SceneSnapshot::savePath(scene);
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+            continue;
+        }
+        Resources::SceneJournal().replay(scene, data);
+        Resources::SceneSnapshot::saveText("Bin/scenes/save_" + stem + ".scn", data);
+    }
 }
 
 void Graph::setScenes()
 {
     scenes = rm.scenes;
     for (Resources::Scene& scene : scenes)
+    {
         scene.setGameObjects();
+
+        // the cells around the players are there on the first frame
+        auto world = worlds.find(scene.name);
+        if (world != worlds.end())
+            world->second.preload(scene, rm);
+    }
 
     scenesLoaded = true;
 
@@ -109,14 +240,14 @@ void Graph::setScenes()
 void Graph::parseSceneList(std::vector<std::string>& sceneList, const char* filePath) const
 {
 	std::string path = std::string(filePath);
-	std::ifstream readFile;
-	readFile.open(path, std::ios::in);
+	Core::IO::AssetFile readFile;
 
-    if (readFile.is_open())
+    if (readFile.open(path))
     {
+        std::istringstream stream(std::string(readFile.data(), readFile.data() + readFile.size()));
         std::string line;
 
-        while (std::getline(readFile, line))
+        while (std::getline(stream, line))
         {
             if(line[0] != '#')
                 sceneList.push_back(line);
@@ -129,550 +260,131 @@ void Graph::parseSceneList(std::vector<std::string>& sceneList, const char* file
     }
 }
 
-void Graph::loadScene(const bool saved)
+void Graph::loadScene(Resources::Scene& scene, const bool saved)
 {
-    std::string path;
-    if (!saved)
-        path = "Bin/scenes/" + rm.scenes.back().name;
-    else
-        path = "Bin/scenes/save_" + rm.scenes.back().name;
-
-    std::ifstream readFile;
-    readFile.open(path, std::ios::in);
-
-    std::map<std::string, std::vector<float>> models;
-    std::map<std::string, std::vector<float>> colliders;
-    std::map<int, std::vector<int>> gameObjects;
-
-    std::vector<int> tags;
-    std::vector<int> attributes;
-
-    std::vector<std::string> customTextures;
-
-    std::vector<std::string> shaderInfo;
-    std::vector<std::string> modelNames;
-    std::vector<std::string> colliderNames;
-    std::vector<float> colliderAttribs;
-    std::vector<float> transform;
-    std::vector<float> cameraInfo;
-
-    std::vector<float> pointLightInfo;
-    std::vector<float> dirLightInfo;
-    std::vector<float> spotLightInfo;
+    // a streamed scene only reads its resident objects, the cells come later
+    bool streamed = Resources::WorldStreamer::enabled && Resources::WorldStreamer::prepare(scene.name);
 
-
-    bool modelNameAdded = false;
-    bool colliderNameAdded = false;
-    bool tagAdded = false;
-
-    if (readFile.is_open())
+    // streamed games save to their own files, the last save written is continued whichever kind it is
+    std::string path = "Bin/scenes/" + scene.name;
+    bool savedStreamed = false;
+    if (saved)
     {
-        std::string line;
-
-        while (std::getline(readFile, line))
+        std::error_code error;
+        savedStreamed = Resources::SceneJournal::latestIsStreamed(scene.name);
+        path = Resources::SceneSnapshot::savePath(scene.name, savedStreamed);
+        if (!std::filesystem::exists(path, error))
         {
-            bool categoryFound = false;
-            std::string category;
-            std::string text;
-
-            for (int i = 0; i < line.length(); ++i)
-            {
-                int iplus1 = i + 1;
-                char c = line[i];
-                if (!categoryFound)
-                {
-                    if (c == ' ')
-                    {
-                        categoryFound = true;
-                    }
-                    else
-                    {
-                        category += c;
-                        continue;
-                    }
-                }
-                else
-                {
-                    if (category == "s")
-                    {
-                        if (c != ' ')
-                            text += c;
-                        if (endOfLine(iplus1, line) || line[iplus1] == ' ')
-                        {
-                            shaderInfo.push_back(text);
-                            text.erase();
-                        }
-                    }
-                    else if (category == "m")
-                    {
-                        if (c != ' ' && c != '/')
-                            text += c;
-                        if (!modelNameAdded && line[iplus1] == ' ')
-                        {
-                            modelNames.push_back(text);
-                            text.erase();
-                            modelNameAdded = true;
-                        }
-                        else if ( line[iplus1] == ' ' || line[iplus1] == '/')
-                        {
-                            transform.push_back(std::stof(text));
-                            text.erase();
-                        }
-                        else if (endOfLine(iplus1, line))
-                        {
-                            transform.push_back(std::stof(text));
-                            std::string name = modelNames.back();
-                            while (models.count(name) > 0)
-                            {
-                                name += "_";
-                            }
-                            modelNames.back() = name;
-                            models.emplace(name, transform);
-                            text.erase();
-                            transform.clear();
-                            modelNameAdded = false;
-                        }
-                    }
-                    else if (category == "t")
-                    {
-                        if (c != ' ' && c != '/')
-                            text += c;
-                        if (endOfLine(iplus1, line))
-                        {
-                            customTextures.push_back(text);
-                        }
-                    }
-                    else if (category == "co")
-                    {
-                        if (c != ' ' && c != '/')
-                            text += c;
-                        if (!colliderNameAdded && line[iplus1] == ' ')
-                        {
-                            colliderNames.push_back(text);
-                            text.erase();
-                            colliderNameAdded = true;
-                        }
-                        else if (line[iplus1] == ' ' || line[iplus1] == '/')
-                        {
-                            colliderAttribs.push_back(std::stof(text));
-                            text.erase();
-                        }
-                        else if (endOfLine(iplus1, line))
-                        {
-                            colliderAttribs.push_back(std::stof(text));
-                            std::string name = colliderNames.back();
-                            while (colliders.count(name) > 0)
-                            {
-                                name += "_";
-                            }
-                            colliders.emplace(modelNames.back(), colliderAttribs);
-                            colliderNames.back() = name;
-                            text.erase();
-                            colliderAttribs.clear();
-                            colliderNameAdded = false;
-                        }
-                    }
-                    else if (category == "c")
-                    {
-                        if (c != ' ' && c != '/')
-                            text += c;
-                        if (endOfLine(iplus1, line) || line[iplus1] == ' ' || line[iplus1] == '/')
-                        {
-                            cameraInfo.push_back(std::stof(text));
-                            text.erase();
-                        }
-                    }
-                    else if (category == "ld" || category == "lp" || category == "ls")
-                    {
-                        if (c != ' ' && c != '/')
-                            text += c;
-                        if (line[iplus1] == ' ' || line[iplus1] == '/')
-                        {
-                            char light = category.back();
-                            switch (light)
-                            {
-                                case 'd':
-                                    dirLightInfo.push_back(std::stof(text));
-                                    break;
-                                case 's':
-                                    spotLightInfo.push_back(std::stof(text));
-                                    break;
-                                case 'p':
-                                    pointLightInfo.push_back(std::stof(text));
-                                    break;
-                                default:
-                                    break;
-                            }
-                            text.erase();
-                        }
-                        else if (endOfLine(iplus1, line))
-                        {
-                            char light = category.back();
-                            switch (light)
-                            {
-                                case 'd':
-                                    dirLightInfo.push_back(std::stof(text));
-                                    rm.scenes.back().dirLights.push_back(LowRenderer::DirectionalLight(dirLightInfo));
-                                    dirLightInfo.clear();
-                                    break;
-                                case 's':
-                                    spotLightInfo.push_back(std::stof(text));
-                                    rm.scenes.back().spotLights.push_back(LowRenderer::SpotLight(spotLightInfo));
-                                    spotLightInfo.clear();
-                                    break;
-                                case 'p':
-                                    pointLightInfo.push_back(std::stof(text));
-                                    rm.scenes.back().pointLights.push_back(LowRenderer::PointLight(pointLightInfo));
-                                    pointLightInfo.clear();
-                                    break;
-                                default:
-                                    break;
-                            }
-                            text.erase();
-                        }
-
-                    }
-                    else if (category == "0" || category == "1" || category == "2")
-                    {
-                        if (!tagAdded)
-                        {
-                            switch (std::stoi(category))
-                            {
-                                case static_cast<int>(Game::Tag::PLAYER):
-                                    tags.push_back(static_cast<int>(Game::Tag::PLAYER));
-                                    break;
-                                case static_cast<int>(Game::Tag::ENEMY) :
-                                    tags.push_back(static_cast<int>(Game::Tag::ENEMY));
-                                    break;
-                                case static_cast<int>(Game::Tag::PLATFORM) :
-                                    tags.push_back(static_cast<int>(Game::Tag::PLATFORM));
-                                    break;
-                                default:
-                                    tags.push_back(static_cast<int>(Game::Tag::UNASSIGNED));
-                                    break;
-                            }
-                            text.erase();
-                            tagAdded = true;
-                        }
-                        if (c != ' ' && c != '/')
-                            text += c;
-                        if (line[iplus1] == ' ' || line[iplus1] == '/')
-                        {
-                            attributes.push_back(std::stoi(text));
-                            text.erase();
-                        }
-                        else if ((i + 1) == (int)line.length())
-                        {
-                            attributes.push_back(std::stoi(text));
-                            gameObjects.emplace(tags.back(), attributes);
-                            text.erase();
-                            attributes.clear();
-                            tagAdded = false;
-                        }
-                    }
-                }
-            }
+            path = "Bin/scenes/save_" + scene.name;
+            savedStreamed = false;
         }
-        readFile.close();
     }
-    else
+
+    // saves are loose files, the scenes shipped with the game may come from the pack
+    Resources::SceneData data;
+    bool loaded = streamed && !saved ? Resources::WorldStreamer::loadResident(scene.name, data)
+        : Resources::SceneSnapshot::loadAny(path, data);
+    if (!loaded)
     {
         std::string statement = "Unable to open file: " + std::string(path);
         Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
     }
-    
 
-    editLightCounts();
+    // a new game writes a new snapshot on its first save
+    Resources::SceneJournal& journal = journals[scene.name];
+    journal = Resources::SceneJournal();
+    if (saved && Resources::SceneSnapshot::isSnapshot(path))
+        journal.replay(scene.name, data, savedStreamed);
 
-    
-    
-        
-    loadModels(models, modelNames, colliders, colliderNames, shaderInfo, gameObjects, customTextures);
-    rm.scenes.back().camera = LowRenderer::Camera(1280, 720, cameraInfo);
-}
+    // the saves made without streaming hold every object, the streamed ones only the resident objects
+    if (streamed)
+    {
+        Resources::WorldStreamer::keepResident(data);
+        worlds[scene.name].open(scene.name);
+    }
+    else if (savedStreamed && !Resources::WorldStreamer::addWorld(scene.name, data))
+    {
+        std::string statement = "Unable to add the world of " + scene.name + " to its streamed save";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+    }
 
-bool Core::DataStructure::Graph::endOfLine(int iplus1, std::string& line)
-{
-    return (iplus1) == line.length();
+    for (const std::vector<float>& light : data.dirLights)
+        scene.dirLights.push_back(LowRenderer::DirectionalLight(light));
+    for (const std::vector<float>& light : data.pointLights)
+        scene.pointLights.push_back(LowRenderer::PointLight(light));
+    for (const std::vector<float>& light : data.spotLights)
+        scene.spotLights.push_back(LowRenderer::SpotLight(light));
+
+    editLightCounts(scene);
+
+    rm.loadModels(scene, data.models);
+    scene.camera = LowRenderer::Camera(1280, 720, data.camera);
+
+    journal.reset(scene.name, std::make_shared<const Resources::SceneData>(std::move(data)), streamed);
 }
 
-void Core::DataStructure::Graph::editLightCounts()
+void Core::DataStructure::Graph::editLightCounts(Resources::Scene& scene)
 {
     // ensuring that there is always 1 enabled dir light in the scene
-    if (rm.scenes.back().dirLights.size() == 0)
+    if (scene.dirLights.size() == 0)
     {
-        rm.scenes.back().dirLights.push_back(LowRenderer::DirectionalLight());
-        rm.scenes.back().dirLights.back().enabled = true;
+        scene.dirLights.push_back(LowRenderer::DirectionalLight());
+        scene.dirLights.back().enabled = true;
     }
     
 
 }
 
-void Graph::saveScene()
-{  
-    std::string path = "Bin/scenes/" + rm.scenes.back().name;
-    std::ifstream sceneFile;
-    sceneFile.open(path, std::ios::in);
-
-    if (!sceneFile.is_open())
-        return;
-
-    std::string savePath = "Bin/scenes/save_" + rm.scenes.back().name;
-    std::ofstream saveFile(savePath);
-
-    if (!saveFile.is_open())
+void Graph::captureScene(const Resources::Scene& scene, const Resources::SceneData& source, Resources::SceneState& state) const
+{
+    const size_t stride = Resources::SceneState::stride;
+    state.values.resize(source.models.size() * stride);
+    state.health.resize(source.models.size());
+    state.camera = scene.camera.getCamInfo();
+    state.compressed = Resources::SceneSnapshot::compressed;
+
+    // game objects were added in the order of the models, in one vector per tag
+    size_t players = 0, enemies = 0, platforms = 0;
+    for (size_t i = 0; i < source.models.size(); ++i)
     {
-        sceneFile.close();
-        return;
-    }
+        const Resources::ModelInfo& model = source.models[i];
+        float* values = state.values.data() + i * stride;
+        int tag = int(model.attribs.back());
+        state.health[i] = model.gameObjectAttribs.empty() ? 0 : model.gameObjectAttribs[0];
 
-    std::string line;
-
-    int gameObjectType = 0;
-    std::cout << "saving" << std::endl;
-    int playerCount = 0;
-    int enemyCount = 0;
-    int platformCount = 0;
-    while (std::getline(sceneFile, line))
-    {
-        switch (line[0])
+        const Game::GameObject* gameObject = nullptr;
+        if (tag == static_cast<int>(Game::Tag::PLAYER) && players < scene.players.size())
         {
-        case 'm':
-            if (line[1] != ' ')
-                break;
-
-            saveFile << line[0] << line[1];
-            for (int i = 2; line[i] != ' '; ++i)
-            {
-                saveFile << line[i];
-            }
-
-            if (line.back() == '0')         //player
-            {
-                gameObjectType = 0;
-                Physics::Transform tr = scenes.back().players[playerCount++].transform;
-
-                saveFile << ' ' << tr.position.x;
-                saveFile << ' ' << tr.position.y;
-                saveFile << ' ' << tr.position.z << '/';
-
-                saveFile << tr.rotation.x;
-                saveFile << ' ' << tr.rotation.y;
-                saveFile << ' ' << tr.rotation.z << '/';
-
-                saveFile << tr.scale.x;
-                saveFile << ' ' << tr.scale.y;
-                saveFile << ' ' << tr.scale.z << " 0\n";
-            }
-            else if (line.back() == '1')    //enemy
-            {
-                gameObjectType = 1;
-                Physics::Transform tr = scenes.back().enemies[enemyCount++].transform;
-
-                saveFile << ' ' << tr.position.x;
-                saveFile << ' ' << tr.position.y;
-                saveFile << ' ' << tr.position.z << '/';
-
-                saveFile << tr.rotation.x;
-                saveFile << ' ' << tr.rotation.y;
-                saveFile << ' ' << tr.rotation.z << '/';
-
-                saveFile << tr.scale.x;
-                saveFile << ' ' << tr.scale.y;
-                saveFile << ' ' << tr.scale.z << " 1\n";
-            }
-            else                            //platform
-            {
-                gameObjectType = 2;
-                Physics::Transform tr = scenes.back().platforms[platformCount++].transform;
-
-                saveFile << ' ' << tr.position.x;
-                saveFile << ' ' << tr.position.y;
-                saveFile << ' ' << tr.position.z << '/';
-
-                saveFile << tr.rotation.x;
-                saveFile << ' ' << tr.rotation.y;
-                saveFile << ' ' << tr.rotation.z << '/';
-
-                saveFile << tr.scale.x;
-                saveFile << ' ' << tr.scale.y;
-                saveFile << ' ' << tr.scale.z << " 2\n";
-            }
-
-            break;
-        case 'c':
-            if (line[1] == 'o')
-            {
-                if (line[2] != ' ')
-                    break;
-
-                saveFile << line[0] << line[1] << line[2];
-                for (int i = 3; line[i] != ' '; ++i)
-                {
-                    saveFile << line[i];
-                }
-
-                if (gameObjectType == 0)
-                {
-                    if (!scenes.back().players.back().shape)
-                    {
-                        saveFile << '\n';
-                        break;
-                    }
-
-                    if (!scenes.back().players.back().shape->sph)
-                    {
-                        saveFile << '\n';
-                        break;
-                    }
-
-                    Core::Maths::Sphere sph = *scenes.back().players.back().shape->sph;
-
-                    saveFile << ' ' << sph.omega.x;
-                    saveFile << ' ' << sph.omega.y;
-                    saveFile << ' ' << sph.omega.z << '/';
-
-                    saveFile << sph.radius;
-                    saveFile << ' ' << sph.radius;
-                    saveFile << ' ' << sph.radius << '\n';
-                }
-                else if (gameObjectType == 1)
-                {
-                    if (!scenes.back().enemies.back().shape)
-                    {
-                        saveFile << '\n';
-                        break;
-                    }
-
-                    if (!scenes.back().enemies.back().shape->sph)
-                    {
-                        saveFile << '\n';
-                        break;
-                    }
-
-                    Core::Maths::Sphere sph = *scenes.back().enemies.back().shape->sph;
-
-                    saveFile << ' ' << sph.omega.x;
-                    saveFile << ' ' << sph.omega.y;
-                    saveFile << ' ' << sph.omega.z << '/';
-
-                    saveFile << sph.radius;
-                    saveFile << ' ' << sph.radius;
-                    saveFile << ' ' << sph.radius << '\n';
-                }
-                else
-                {
-                    if (!scenes.back().platforms.back().shape)
-                    {
-                        saveFile << '\n';
-                        break;
-                    }
-
-                    if (!scenes.back().platforms.back().shape->b)
-                    {
-                        saveFile << '\n';
-                        break;
-                    }
-
-                    Core::Maths::Box b = *scenes.back().platforms.back().shape->b;
-
-                    saveFile << ' ' << b.center.x;
-                    saveFile << ' ' << b.center.y;
-                    saveFile << ' ' << b.center.z << '/';
-
-                    saveFile << b.extensions.x;
-                    saveFile << ' ' << b.extensions.y;
-                    saveFile << ' ' << b.extensions.z << '\n';
-                }
-            }
-            else if (line[1] == ' ')
-            {
-                saveFile << line[0] << line[1];
-
-                LowRenderer::Camera cam = scenes.back().camera;
-
-                saveFile << cam.getCamInfo()[0] << ' ';
-                saveFile << cam.getCamInfo()[1] << ' ';
-                saveFile << cam.getCamInfo()[2] << '/';
-                saveFile << cam.getCamInfo()[3] << ' ';
-                saveFile << cam.getCamInfo()[4] << '/';
-                saveFile << cam.getCamInfo()[5] << ' ';
-                saveFile << cam.getCamInfo()[6] << ' ';
-                saveFile << cam.getCamInfo()[7] << '/';
-                saveFile << cam.getCamInfo()[8] << ' ';
-                saveFile << cam.getCamInfo()[9] << '\n';
-            }
-
-            break;
-        case 's':
-            if (line[1] != ' ')
-                break;
-
-            saveFile << line << '\n';
-
-            break;
-        case 'l':
-            if (line[1] != 'd')
-                break;
-
-            saveFile << line << '\n';
-
-            break;
-        case '0':
+            const Game::Player& player = scene.players[players++];
+            state.health[i] = player.getHealth();
+            gameObject = &player;
+        }
+        else if (tag == static_cast<int>(Game::Tag::ENEMY) && enemies < scene.enemies.size())
+            gameObject = &scene.enemies[enemies++];
+        else if (tag == static_cast<int>(Game::Tag::PLATFORM) && platforms < scene.platforms.size())
+            gameObject = &scene.platforms[platforms++];
+
+        std::copy(model.attribs.begin(), model.attribs.end(), values);
+        std::copy(model.colliderAttribs.begin(), model.colliderAttribs.end(), values + model.attribs.size());
+        if (!gameObject)
+            continue;
+
+        const Physics::Transform& tr = gameObject->transform;
+        const float transform[] = { tr.position.x, tr.position.y, tr.position.z, tr.rotation.x, tr.rotation.y, tr.rotation.z,
+            tr.scale.x, tr.scale.y, tr.scale.z };
+        std::copy(std::begin(transform), std::end(transform), values);
+
+        if (gameObject->shape && gameObject->shape->sph)
         {
-            if (line[1] != ' ')
-                break;
-
-            int health = scenes.back().players.back().getHealth();
-            saveFile << line[0] << line[1] << health <<'\n';
-
-            break;
+            const Core::Maths::Sphere& sph = *gameObject->shape->sph;
+            const float collider[] = { sph.omega.x, sph.omega.y, sph.omega.z, sph.radius, sph.radius, sph.radius };
+            std::copy(std::begin(collider), std::end(collider), values + model.attribs.size());
         }
-        case '1':
-            if (line[1] != ' ')
-                break;
-
-            saveFile << line << '\n';
-
-            break;
-        case '2':
-            if (line[1] != ' ')
-                break;
-
-            saveFile << line << '\n';
-
-            break;
-        default:
-            saveFile << line << (sceneFile.eof() ? '\0' : '\n');
-            break;
+        else if (gameObject->shape && gameObject->shape->b)
+        {
+            const Core::Maths::Box& b = *gameObject->shape->b;
+            const float collider[] = { b.center.x, b.center.y, b.center.z, b.extensions.x, b.extensions.y, b.extensions.z };
+            std::copy(std::begin(collider), std::end(collider), values + model.attribs.size());
         }
     }
-
-    std::cout << "saved" << std::endl;
-    sceneFile.close();
-    saveFile.close();
-}
-
-void	Graph::loadModels(std::map<std::string, std::vector<float>>& models, std::vector<std::string>& modelNames, 
-    std::map<std::string, std::vector<float>>& colliders, const std::vector<std::string>& colliderNames,
-    const std::vector<std::string>& shaderInfo, std::map<int, std::vector<int>>& gameObjects,
-    const std::vector<std::string>& customTextures)
-{
-    // ASSERT
-    Core::Debug::Assertion::assertTest(models.size() == modelNames.size());
-    Core::Debug::Assertion::assertTest(models.size() == colliders.size());
-    Core::Debug::Assertion::assertTest(models.size() == colliderNames.size());
-    Core::Debug::Assertion::assertTest(shaderInfo.size() == models.size() * 4);
-
-    int index = 0;
-    for (std::string& modelName : modelNames)
-    {
-        int i = index * 4;
-        int j = i + 1;
-        int k = j + 1;
-        int l = k + 1;
-        std::vector<std::string> modelShaders = { shaderInfo[i], shaderInfo[j], shaderInfo[k], shaderInfo[l] };
-        rm.loadObj(modelName, models[modelName], colliderNames[index], colliders[modelName],  modelShaders, gameObjects[models[modelName].back()], customTextures[index]);
-        ++index;
-    }
 }
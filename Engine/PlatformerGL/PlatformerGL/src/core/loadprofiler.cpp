@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "core/debug/loadprofiler.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Core::Debug;
+
+bool LoadProfiler::enabled = true;
+size_t LoadProfiler::tableRows = 20;
+
+namespace
+{
+    const char* stageNames[] = { "OBJ parse", "Mesh optimize", "LOD build", "MTL parse", "Texture decode", "GL upload", "Shader compile" };
+
+    static_assert(sizeof(stageNames) / sizeof(stageNames[0]) == size_t(LoadStage::COUNT), "a name for every load stage");
+
+    std::string jsonString(const std::string& value)
+    {
+        std::string escaped = "\"";
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped + "\"";
+    }
+
+    std::string fixed(double value)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+        return buffer;
+    }
+}
+
+LoadProfiler::Scope::Scope(LoadStage stage, const std::string& name)
+    : stage(stage), name(name), start(std::chrono::steady_clock::now())
+{
+}
+
+LoadProfiler::Scope::~Scope()
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    LoadProfiler::getInstance().record(stage, name, elapsed.count(), bytes);
+}
+
+void LoadProfiler::begin(const std::string& sessionName)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    records.clear();
+    caches.clear();
+    session = sessionName;
+    start = std::chrono::steady_clock::now();
+    recording = enabled;
+    finishing = false;
+}
+
+void LoadProfiler::record(LoadStage stage, const std::string& name, double milliseconds, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (recording)
+        records.push_back({ stage, name, milliseconds, bytes });
+}
+
+void LoadProfiler::cacheHit(const std::string& cache)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (recording)
+        ++caches[cache].hits;
+}
+
+void LoadProfiler::cacheMiss(const std::string& cache)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (recording)
+        ++caches[cache].misses;
+}
+
+void LoadProfiler::finish(size_t pendingJobs)
+{
+    if (!recording)
+        return;
+
+    finishing = true;
+    std::string statement = "Load profile of " + session + " written once " + std::to_string(pendingJobs) + " streamed textures are uploaded";
+    Log::print(statement, LogType::INFO);
+}
+
+void LoadProfiler::update(size_t pendingJobs)
+{
+    if (finishing && pendingJobs == 0)
+        report();
+}
+
+void LoadProfiler::report()
+{
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - start;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        recording = false;
+        finishing = false;
+    }
+
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b)
+    {
+        return a.milliseconds > b.milliseconds;
+    });
+
+    double stageMilliseconds[size_t(LoadStage::COUNT)] = {};
+    size_t stageBytes[size_t(LoadStage::COUNT)] = {};
+    size_t stageCounts[size_t(LoadStage::COUNT)] = {};
+    for (const Record& record : records)
+    {
+        stageMilliseconds[size_t(record.stage)] += record.milliseconds;
+        stageBytes[size_t(record.stage)] += record.bytes;
+        ++stageCounts[size_t(record.stage)];
+    }
+
+    std::string statement = "Load profile of " + session + ": " + std::to_string(records.size()) + " assets in " + fixed(wall.count()) + " ms";
+    Log::print(statement, LogType::INFO);
+
+    // stages run in parallel on the thread pool, their sum can exceed the wall time
+    for (size_t stage = 0; stage < size_t(LoadStage::COUNT); ++stage)
+    {
+        if (stageCounts[stage] == 0)
+            continue;
+
+        statement = "  " + std::string(stageNames[stage]) + " | " + std::to_string(stageCounts[stage]) + " assets | "
+            + fixed(stageMilliseconds[stage]) + " ms | " + std::to_string(stageBytes[stage] / 1024) + " KB";
+        Log::print(statement, LogType::INFO);
+    }
+
+    for (size_t i = 0; i < records.size() && i < tableRows; ++i)
+    {
+        const Record& record = records[i];
+        statement = "  " + fixed(record.milliseconds) + " ms | " + std::to_string(record.bytes / 1024) + " KB | "
+            + stageNames[size_t(record.stage)] + " | " + record.name;
+        Log::print(statement, LogType::INFO);
+    }
+
+    for (const auto& cache : caches)
+    {
+        size_t lookups = cache.second.hits + cache.second.misses;
+        statement = "  Cache " + cache.first + " | " + std::to_string(cache.second.hits) + " hits, " + std::to_string(cache.second.misses)
+            + " misses | " + fixed(lookups > 0 ? 100.0 * double(cache.second.hits) / double(lookups) : 0.0) + " % hit rate";
+        Log::print(statement, LogType::INFO);
+    }
+
+    writeJson(wall.count());
+}
+
+void LoadProfiler::writeJson(double wallMilliseconds) const
+{
+    std::ofstream json("Logs/load_profile.json", std::ofstream::trunc);
+    if (!json.is_open())
+    {
+        Log::print("Unable to write Logs/load_profile.json", LogType::WARNING);
+        return;
+    }
+
+    json << "{\n  \"session\": " << jsonString(session) << ",\n  \"wall_ms\": " << fixed(wallMilliseconds) << ",\n  \"assets\": [";
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const Record& record = records[i];
+        json << (i == 0 ? "\n" : ",\n") << "    { \"stage\": " << jsonString(stageNames[size_t(record.stage)])
+            << ", \"name\": " << jsonString(record.name) << ", \"ms\": " << fixed(record.milliseconds)
+            << ", \"bytes\": " << record.bytes << " }";
+    }
+
+    json << "\n  ],\n  \"caches\": {";
+    bool first = true;
+    for (const auto& cache : caches)
+    {
+        json << (first ? "\n" : ",\n") << "    " << jsonString(cache.first) << ": { \"hits\": " << cache.second.hits
+            << ", \"misses\": " << cache.second.misses << " }";
+        first = false;
+    }
+    json << "\n  }\n}\n";
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <chrono>
+#include <mutex>
 #include <direct.h>
 
 #include <date/date.h>
@@ -16,6 +17,9 @@ std::streambuf* Log::coutbuf = std::cout.rdbuf(); //save old buf
 std::ofstream Log::outError("Logs/error.log", std::ofstream::app);
 std::streambuf* Log::cerrbuf = std::cerr.rdbuf();
 
+// print swaps the stream buffers of cout/cerr, the loaders call it from worker threads
+static std::mutex printMutex;
+
 void Log::redirectLogs(const LogOptions& type)
 {
 	switch (type)
@@ -152,6 +156,7 @@ void	Log::print(const std::string& statement, const LogType& logType)
 	auto hybridOption = LogOptions::HYBRID;
 	if (enabled)
 	{
+		std::unique_lock<std::mutex> lock(printMutex);
 		switch (logType)
 		{
 			case LogType::INFO :
@@ -165,6 +170,7 @@ void	Log::print(const std::string& statement, const LogType& logType)
 				std::cerr << "ERROR LOG: " << statement << std::endl;
 				Log::endRedirect(errOption);
 				std::cout << "ERROR LOG: " << statement << std::endl;
+				lock.unlock();
 				exit(1);
 				break;
 			case LogType::WARNING :
@@ -178,6 +184,7 @@ void	Log::print(const std::string& statement, const LogType& logType)
 				std::cerr << "FATAL LOG: " << statement << std::endl;
 				Log::endRedirect(errOption);
 				std::cerr << "FATAL LOG: " << statement << std::endl;
+				lock.unlock();
 				exit(1);
 				break;
 			case LogType::DEBUG :
@@ -0,0 +1,98 @@
+#include "core/datastructure/threadpool.hpp"
+
+using namespace Core::DataStructure;
+
+ThreadPool::ThreadPool()
+{
+    // the main thread also works during parallelFor, keep one core for it
+    unsigned int cores = std::thread::hardware_concurrency();
+    size_t workerCount = cores > 1 ? cores - 1 : 1;
+
+    for (size_t i = 0; i < workerCount; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = true;
+    }
+    jobsCondition.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::push(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.push_back(std::move(job));
+    }
+    jobsCondition.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobsCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+            if (stopping && jobs.empty())
+                return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+    if (count == 0)
+        return;
+
+    // shared so helpers that start after the loop is finished only touch live data
+    struct Loop
+    {
+        std::function<void(size_t)> job;
+        std::atomic<size_t>         next{ 0 };
+        std::atomic<size_t>         done{ 0 };
+        size_t                      count = 0;
+        std::mutex                  mutex;
+        std::condition_variable     finished;
+    };
+
+    auto loop = std::make_shared<Loop>();
+    loop->job = job;
+    loop->count = count;
+
+    auto work = [loop]()
+    {
+        size_t index;
+        while ((index = loop->next.fetch_add(1)) < loop->count)
+        {
+            loop->job(index);
+            if (loop->done.fetch_add(1) + 1 == loop->count)
+            {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = count - 1 < workers.size() ? count - 1 : workers.size();
+    for (size_t i = 0; i < helpers; ++i)
+        push(work);
+
+    // the caller takes its share, which also keeps nested calls from a worker deadlock free
+    work();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&loop]() { return loop->done.load() == loop->count; });
+}
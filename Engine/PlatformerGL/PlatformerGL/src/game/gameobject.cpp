@@ -1,3 +1,5 @@
+#include <chrono>
+
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_opengl3.h>
@@ -8,6 +10,7 @@
 #include "core/maths/box.hpp"
 #include "core/maths/sphere.hpp"
 #include "core/debug/assertion.hpp"
+#include "core/debug/loadprofiler.hpp"
 
 using namespace Game;
 using namespace Core::Maths;
@@ -107,67 +110,63 @@ void    GameObject::addMesh()
     model.meshes.push_back(Resources::Mesh(transform));
 }
 
-void    GameObject::loadTextures(const std::vector<std::string>& materials, const std::vector<std::string>& texFiles,
-            std::map<std::string, unsigned int>& cachedTextures)
+std::vector<std::string>    GameObject::textureFiles(const Resources::MaterialLibrary& library) const
 {
+    // diffuse map of every mesh, empty when the mesh has none
+    std::vector<std::string> files(model.meshes.size());
+    const Resources::MaterialRegistry& registry = Resources::MaterialRegistry::getInstance();
 
+    size_t firstMaterialMesh = 0;
     if (customTexture != "None" && model.meshes.size() == 2)
     {
-        if (cachedTextures.count(customTexture) > 0)
-        {
-            model.meshes[0].texture.texCount = cachedTextures[customTexture];
-        }
-        else
-        {
-            cachedTextures.emplace(customTexture, model.meshes[0].texture.bindTexture());
-            model.meshes[0].texture.processTexData(customTexture);
-        }
-            
-        for (int i = 0; i < materials.size(); ++i)
-        {
-            if (model.meshes[1].materialsInfo == materials.at(i))
-            {
-                model.meshes[1].texture.bindTexture();
-                Core::Debug::Assertion::assertTest(!texFiles[i].empty());
-                if (cachedTextures.count(materials[i]) > 0)
-                    model.meshes[1].texture.texCount = cachedTextures[texFiles[i]];
-                else
-                {
-                    cachedTextures.emplace(texFiles[i], model.meshes[1].texture.bindTexture());
-                    model.meshes[1].texture.processTexData(texFiles[i]);
-                }
-            }
-        }
+        files[0] = customTexture;
+        firstMaterialMesh = 1;
     }
-    else
+
+    for (size_t mesh = firstMaterialMesh; mesh < model.meshes.size(); ++mesh)
     {
-        for (Resources::Mesh& mesh : model.meshes)
-        {
-            for (int i = 0; i < materials.size(); ++i)
-            {
-                if (mesh.materialsInfo == materials.at(i))
-                {
-                    mesh.texture.bindTexture();
-                    Core::Debug::Assertion::assertTest(!texFiles[i].empty());
-                    if (cachedTextures.count(materials[i]) > 0)
-                        mesh.texture.texCount = cachedTextures[texFiles[i]];
-                    else
-                    {
-                        cachedTextures.emplace(texFiles[i], mesh.texture.bindTexture());
-                        mesh.texture.processTexData(texFiles[i]);
-                    }
-                }
-            }
-        }
+        auto material = library.materials.find(model.meshes[mesh].materialsInfo);
+        if (material != library.materials.end())
+            files[mesh] = registry.get(material->second).map(Resources::Material::Map::DIFFUSE);
+    }
+
+    return files;
+}
+
+void    GameObject::setMaterials(const Resources::MaterialLibrary& library)
+{
+    for (Resources::Mesh& mesh : model.meshes)
+        mesh.material = library.find(mesh.materialsInfo);
+}
+
+void    GameObject::setTextures(const std::vector<Resources::TextureHandle>& textures)
+{
+    // a mesh without texture also drops the one a reload may have removed
+    for (size_t i = 0; i < textures.size() && i < model.meshes.size(); ++i)
+    {
+        model.meshes[i].texture.handle = textures[i];
+        model.meshes[i].texture.texCount = textures[i].id();
     }
-    
 }
 
 void    GameObject::defineVAO()
 {
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+
     for (int i = 0; i < model.meshes.size(); ++i)
     {
+        // the other instances of the model find the data already uploaded
+        bool uploaded = !model.meshes[i].hasData() || model.meshes[i].getData().isUploaded();
         model.meshes[i].defineVAO();
+        if (!uploaded)
+            bytes += model.meshes[i].getData().getGpuBytes();
+    }
+
+    if (bytes > 0)
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        Core::Debug::LoadProfiler::getInstance().record(Core::Debug::LoadStage::GL_UPLOAD, model.name, elapsed.count(), bytes);
     }
 }
 
@@ -210,6 +209,22 @@ void GameObject::showImGuiControls()
         ImGui::SliderFloat3("scale", transform.scale.e, 0.01f, 5.f);
     }
 
+    if (ImGui::CollapsingHeader("LODs"))
+    {
+        // the last mesh is the collider
+        for (size_t i = 0; i + 1 < model.meshes.size(); ++i)
+        {
+            const Resources::Mesh& mesh = model.meshes[i];
+            if (!mesh.hasData())
+                continue;
+
+            std::string triangles;
+            for (int level = 0; level < mesh.getData().getLevelCount(); ++level)
+                triangles += (level > 0 ? " / " : "") + std::to_string(mesh.getData().getLevelIndexCount(level) / 3);
+            ImGui::Text("mesh %d: LOD %d | %s", int(i), mesh.lod, triangles.c_str());
+        }
+    }
+
     if (ImGui::CollapsingHeader("Collider", ImGuiTreeNodeFlags_DefaultOpen))
     {
         ImGui::Checkbox("Visible", &model.colliderVisible);
@@ -118,9 +118,14 @@ vec3 Camera::getCamPos() const
     return position;
 }
 
-float* Camera::getCamInfo() const
+float Camera::getFovY() const
 {
-    float info[10];
+    return fovY;
+}
+
+std::vector<float> Camera::getCamInfo() const
+{
+    std::vector<float> info(10);
 
     info[0] = position.x;
     info[1] = position.y;
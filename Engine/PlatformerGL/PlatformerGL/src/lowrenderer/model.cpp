@@ -56,6 +56,7 @@ void LowRenderer::Model::setShaderAttrib(const Core::Maths::mat4& mvp, const Cor
     gfxShader.setVec3("modelColor", gfxColor);
     gfxShader.setVec3("camPos", camPos);
     gfxShader.setBool("outline", outline);
+    gfxShader.setInt("textureArray", 1);
 }
 
 void    LowRenderer::Model::setLights(
@@ -0,0 +1,124 @@
+#include <algorithm>
+
+#include "resources/material.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Resources;
+
+namespace
+{
+    // std140 layout of the Material struct of the shaders
+    struct GpuMaterial
+    {
+        float   ambient[4];
+        float   diffuse[4];     // w: opacity
+        float   specular[4];    // w: shininess
+    };
+
+    static_assert(sizeof(GpuMaterial) == 48, "GpuMaterial must match the std140 Material struct");
+
+    GpuMaterial toGpu(const Material& material)
+    {
+        GpuMaterial gpu = {
+            { material.ambient.x, material.ambient.y, material.ambient.z, 1.f },
+            { material.diffuse.x, material.diffuse.y, material.diffuse.z, material.opacity },
+            { material.specular.x, material.specular.y, material.specular.z, material.shininess }
+        };
+        return gpu;
+    }
+}
+
+MaterialHandle MaterialLibrary::find(const std::string& name) const
+{
+    auto found = materials.find(name);
+    return found != materials.end() ? found->second : MaterialHandle();
+}
+
+MaterialRegistry::MaterialRegistry()
+{
+    // slot 0, used by the meshes without material
+    Material fallback;
+    fallback.name = "default";
+    materials.push_back(fallback);
+}
+
+const MaterialLibrary& MaterialRegistry::add(const std::string& materialsFile, std::vector<Material>&& fileMaterials)
+{
+    MaterialLibrary& library = libraries[materialsFile];
+
+    for (Material& material : fileMaterials)
+    {
+        auto found = library.materials.find(material.name);
+        if (found != library.materials.end())
+        {
+            materials[found->second.index()] = std::move(material);
+            continue;
+        }
+
+        if (materials.size() >= maxMaterials)
+        {
+            if (!fullReported)
+            {
+                std::string statement = "Material buffer full (" + std::to_string(maxMaterials) + "), "
+                    + material.name + " of " + materialsFile + " uses the default material";
+                Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+                fullReported = true;
+            }
+            continue;
+        }
+
+        library.materials.emplace(material.name, MaterialHandle(static_cast<unsigned int>(materials.size())));
+        materials.push_back(std::move(material));
+    }
+
+    dirty = true;
+    return library;
+}
+
+const MaterialLibrary& MaterialRegistry::find(const std::string& materialsFile) const
+{
+    static const MaterialLibrary empty;
+
+    auto found = libraries.find(materialsFile);
+    return found != libraries.end() ? found->second : empty;
+}
+
+bool MaterialRegistry::contains(const std::string& materialsFile) const
+{
+    return libraries.count(materialsFile) > 0;
+}
+
+const Material& MaterialRegistry::get(MaterialHandle handle) const
+{
+    return materials[std::min(size_t(handle.index()), materials.size() - 1)];
+}
+
+void MaterialRegistry::upload()
+{
+    if (!dirty)
+        return;
+
+    std::vector<GpuMaterial> gpuMaterials(maxMaterials);
+    for (size_t i = 0; i < materials.size(); ++i)
+        gpuMaterials[i] = toGpu(materials[i]);
+
+    // the whole block is allocated once, the programs bind it through the binding of the block
+    if (buffer == 0)
+    {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(GpuMaterial) * gpuMaterials.size(), gpuMaterials.data(), GL_STATIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, buffer);
+    }
+    else
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GpuMaterial) * materials.size(), gpuMaterials.data());
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    dirty = false;
+
+    std::string statement = "Materials uploaded: " + std::to_string(materials.size()) + " in " + std::to_string(libraries.size()) + " files";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
+}
@@ -1,10 +1,17 @@
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
 
 #include "resources/mesh.hpp"
 #include "core/core.hpp"
+#include "core/debug/log.hpp"
 
 using namespace Resources;
 using namespace Core::Maths;
 
+bool Mesh::keepCpuData = false;
+
 Mesh::Mesh(const std::string materialsInfo, const Physics::Transform& modelTransform) : materialsInfo(materialsInfo), worldTransform(modelTransform)
 {
     
@@ -24,32 +31,78 @@ Mesh::Mesh(const Mesh& other)
 void Mesh::operator=(const Mesh& other)
 {
     materialsInfo = other.materialsInfo;
-    rdrVertices = other.rdrVertices;
-    indices = other.indices;
+    data = other.data;
     texture = other.texture;
+    material = other.material;
 
     worldTransform = other.worldTransform;
     faceType = other.faceType;
-    VAO = other.VAO;
-    EBO = other.EBO;
+    lod = other.lod;
 }
 
-void Mesh::setIndices()
+void Mesh::setGeometry(std::vector<Core::rdrVertex>&& vertices, std::vector<unsigned int>&& indices,
+    std::vector<std::vector<unsigned int>>&& lods)
 {
-    int vertexCount = rdrVertices.size();
-    for (int i = 0; i < vertexCount; ++i)
-        indices.push_back(i);
+    if (indices.empty())
+    {
+        indices.resize(vertices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+            indices[i] = unsigned(i);
+    }
+
+    data = std::make_shared<MeshData>(std::move(vertices), std::move(indices), std::move(lods));
+    lod = 0;
 }
 
 void    Mesh::defineVAO()
 {
-    processVAO();
-    setAttributes();
+    // instances of a model share its data, only the first one uploads it
+    if (data && !data->isUploaded())
+        data->upload(keepCpuData);
+}
+
+MeshData::MeshData(std::vector<Core::rdrVertex>&& vertices, std::vector<unsigned int>&& indices,
+    std::vector<std::vector<unsigned int>>&& lods)
+    : rdrVertices(std::move(vertices)), indices(std::move(indices)), lods(std::move(lods))
+{
+    vertexCount = rdrVertices.size();
+    indexCount = this->indices.size();
+
+    // offsets are filled at upload, once the index size is known
+    levels.push_back({ 0, indexCount });
+    for (const std::vector<unsigned int>& level : this->lods)
+        levels.push_back({ 0, level.size() });
+
+    if (rdrVertices.empty())
+        return;
+
+    vec3 min = { rdrVertices[0].x, rdrVertices[0].y, rdrVertices[0].z };
+    vec3 max = min;
+    for (const Core::rdrVertex& vertex : rdrVertices)
+    {
+        min = { std::min(min.x, vertex.x), std::min(min.y, vertex.y), std::min(min.z, vertex.z) };
+        max = { std::max(max.x, vertex.x), std::max(max.y, vertex.y), std::max(max.z, vertex.z) };
+    }
+    boundsCenter = (min + max) / 2.f;
+    boundsRadius = mag(max - boundsCenter);
+}
+
+MeshData::~MeshData()
+{
+    // the buffers are already gone with the context at exit
+    if (VAO == 0 || !glfwGetCurrentContext())
+        return;
+
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
 }
 
-void Mesh::processVAO()
+void MeshData::upload(bool keepCpuData)
 {
-    GLuint VBO;
+    if (VAO != 0)
+        return;
+
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
     glGenBuffers(1, &VBO);
@@ -59,33 +112,57 @@ void Mesh::processVAO()
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 
+    // the levels follow each other in the index buffer
+    std::vector<unsigned int> allLevels = indices;
+    for (const std::vector<unsigned int>& level : lods)
+        allLevels.insert(allLevels.end(), level.begin(), level.end());
+
+    PackedMesh packed;
+    VertexPacker::pack(rdrVertices, allLevels, packed);
+
+    size_t indexSize = packed.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    size_t offset = 0;
+    for (Level& level : levels)
+    {
+        level.offset = offset * indexSize;
+        offset += level.count;
+    }
+
     glBufferData(
         GL_ARRAY_BUFFER,
-        sizeof(rdrVertices.front()) * rdrVertices.size(),
-        rdrVertices.data(),
+        GLsizeiptr(packed.vertexData.size()),
+        packed.vertexData.data(),
         GL_STATIC_DRAW
     );
 
     glBufferData(
         GL_ELEMENT_ARRAY_BUFFER,
-        sizeof(indices.front()) * indices.size(),
-        indices.data(),
+        GLsizeiptr(packed.indexData.size()),
+        packed.indexData.data(),
         GL_STATIC_DRAW
     );
-}
 
-void Resources::Mesh::setAttributes()
-{
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // color attribute
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // normal attribute
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(7 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture coordinate attribute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-}
\ No newline at end of file
+    packed.format->apply();
+    gpuBytes = packed.vertexData.size() + packed.indexData.size();
+
+    indexType = packed.indexType;
+    positionScale = packed.positionScale;
+    positionOffset = packed.positionOffset;
+
+    if (VertexPacker::reportError)
+    {
+        RoundTripError error = VertexPacker::roundTripError(rdrVertices, packed);
+        std::string statement = "Mesh upload: " + std::to_string(vertexCount) + " vertices | "
+            + std::to_string(sizeof(Core::rdrVertex)) + " -> " + std::to_string(packed.format->stride) + " bytes per vertex, "
+            + (indexType == GL_UNSIGNED_SHORT ? "16" : "32") + " bit indices | max error: position "
+            + std::to_string(error.position) + ", normal " + std::to_string(error.normal) + " deg, uv " + std::to_string(error.texCoord);
+        Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+    }
+
+    if (!keepCpuData)
+    {
+        std::vector<Core::rdrVertex>().swap(rdrVertices);
+        std::vector<unsigned int>().swap(indices);
+        std::vector<std::vector<unsigned int>>().swap(lods);
+    }
+}
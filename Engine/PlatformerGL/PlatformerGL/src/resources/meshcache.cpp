@@ -0,0 +1,396 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "resources/meshcache.hpp"
+#include "resources/meshcodec.hpp"
+#include "resources/meshoptimizer.hpp"
+#include "resources/meshsimplifier.hpp"
+#include "core/io/mappedfile.hpp"
+#include "core/io/assetpack.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Resources;
+
+bool MeshCache::enabled = true;
+std::string MeshCache::directory = "Assets/cache/";
+
+namespace
+{
+    const char      magic[4] = { 'P', 'G', 'L', 'M' };
+    const uint32_t  version = 7;
+
+    struct SourceStamp
+    {
+        uint64_t    size = 0;
+        int64_t     modified = 0;
+        uint64_t    hash = 0;
+        bool        packed = false;
+    };
+
+    // settings the meshes were processed with, a cache baked with other ones is rebuilt
+    struct ProcessStamp
+    {
+        uint32_t    optimized = 0;
+        uint32_t    cacheSize = 0;
+        uint32_t    lodCount = 0;       // 0 without LODs
+        float       lodError = 0.f;
+
+        bool operator==(const ProcessStamp& other) const
+        {
+            return optimized == other.optimized && cacheSize == other.cacheSize
+                && lodCount == other.lodCount && lodError == other.lodError;
+        }
+    };
+
+    ProcessStamp currentProcess()
+    {
+        ProcessStamp stamp;
+        if (MeshOptimizer::enabled)
+        {
+            stamp.optimized = 1;
+            stamp.cacheSize = MeshOptimizer::cacheSize;
+        }
+        if (MeshSimplifier::enabled && MeshSimplifier::lodCount > 0)
+        {
+            stamp.lodCount = uint32_t(MeshSimplifier::lodCount);
+            stamp.lodError = MeshSimplifier::maxError;
+        }
+        return stamp;
+    }
+
+    bool statSource(const std::string& path, SourceStamp& stamp)
+    {
+        // a packed source has no modification time, its content hash is in the pack
+        if (Core::IO::AssetPack::getInstance().stat(path, stamp.size, stamp.hash))
+        {
+            stamp.modified = 0;
+            stamp.packed = true;
+            return true;
+        }
+
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(path, error);
+        if (error)
+            return false;
+
+        std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+        if (error)
+            return false;
+
+        stamp.size = uint64_t(size);
+        stamp.modified = int64_t(modified.time_since_epoch().count());
+        return true;
+    }
+
+    // only used to tell whether a touched source really changed
+    bool hashSource(const std::string& path, SourceStamp& stamp)
+    {
+        if (stamp.packed)
+            return true;
+
+        Core::IO::MappedFile file;
+        if (!file.open(path))
+            return false;
+
+        stamp.hash = Core::IO::AssetPack::hash(file.data(), file.size());
+        return true;
+    }
+
+    // smallest mesh record: empty material name, face type, counts, empty streams and LOD count
+    const size_t    minMeshBytes = 7 * sizeof(uint32_t);
+    // smallest LOD record: index count and empty stream
+    const size_t    minLodBytes = 2 * sizeof(uint32_t);
+
+    // decoded indices are handed to the GPU as they are, one past the vertices would read out of the buffer
+    bool inRange(const std::vector<unsigned int>& indices, size_t vertexCount)
+    {
+        for (unsigned int index : indices)
+        {
+            if (index >= vertexCount)
+                return false;
+        }
+        return true;
+    }
+
+    // bounds checked reads from the mapped cache, counts are checked against the bytes left before anything
+    // is allocated for them so a damaged file is rejected instead of asking for gigabytes
+    struct Reader
+    {
+        const char* cursor;
+        const char* end;
+
+        bool fits(uint32_t count, size_t minBytes) const
+        {
+            return count <= size_t(end - cursor) / minBytes;
+        }
+
+        template<typename T>
+        bool read(T& value)
+        {
+            if (size_t(end - cursor) < sizeof(T))
+                return false;
+
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return true;
+        }
+
+        bool readBytes(void* destination, size_t size)
+        {
+            if (size_t(end - cursor) < size)
+                return false;
+
+            if (size > 0)
+                std::memcpy(destination, cursor, size);
+            cursor += size;
+            return true;
+        }
+
+        bool readString(std::string& value)
+        {
+            uint32_t length = 0;
+            if (!read(length) || size_t(end - cursor) < length)
+                return false;
+
+            value.assign(cursor, length);
+            cursor += length;
+            return true;
+        }
+
+        // geometry streams are stored encoded by MeshCodec behind their size
+        bool readVertices(std::vector<Core::rdrVertex>& vertices, uint32_t count)
+        {
+            uint32_t size = 0;
+            if (!read(size) || size_t(end - cursor) < size || count > MeshCodec::maxCount(size, sizeof(Core::rdrVertex)))
+                return false;
+
+            const unsigned char* encoded = reinterpret_cast<const unsigned char*>(cursor);
+            cursor += size;
+            vertices.resize(count);
+            return MeshCodec::decodeVertices(vertices.data(), vertices.size(), sizeof(Core::rdrVertex), encoded, size);
+        }
+
+        bool readIndices(std::vector<unsigned int>& indices, uint32_t count)
+        {
+            uint32_t size = 0;
+            if (!read(size) || size_t(end - cursor) < size || count > MeshCodec::maxCount(size, sizeof(unsigned int)))
+                return false;
+
+            const unsigned char* encoded = reinterpret_cast<const unsigned char*>(cursor);
+            cursor += size;
+            indices.resize(count);
+            return MeshCodec::decodeIndices(indices.data(), indices.size(), encoded, size);
+        }
+    };
+
+    template<typename T>
+    void write(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(std::ofstream& file, const std::string& value)
+    {
+        write(file, uint32_t(value.size()));
+        file.write(value.data(), std::streamsize(value.size()));
+    }
+
+    void writeStream(std::ofstream& file, const std::vector<unsigned char>& encoded)
+    {
+        write(file, uint32_t(encoded.size()));
+        file.write(reinterpret_cast<const char*>(encoded.data()), std::streamsize(encoded.size()));
+    }
+}
+
+std::string MeshCache::cachePath(const std::string& modelName, const std::string& colliderName)
+{
+    // two pairs joining to the same name only rebake, load checks the source paths stored in the file
+    return directory + modelName + "." + colliderName + ".pglmesh";
+}
+
+bool MeshCache::load(const std::string& cacheFile, const std::vector<std::string>& sources,
+    const Physics::Transform& transform, std::string& materialsFile, std::vector<Mesh>& meshes)
+{
+    if (!enabled)
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    Core::IO::MappedFile file;
+    if (!file.open(cacheFile))
+        return false;
+
+    Reader reader = { file.data(), file.data() + file.size() };
+
+    char fileMagic[4];
+    uint32_t fileVersion = 0;
+    ProcessStamp process;
+    uint32_t sourceCount = 0;
+    if (!reader.readBytes(fileMagic, sizeof(fileMagic)) || std::memcmp(fileMagic, magic, sizeof(magic)) != 0
+        || !reader.read(fileVersion) || fileVersion != version
+        || !reader.read(process.optimized) || !reader.read(process.cacheSize)
+        || !reader.read(process.lodCount) || !reader.read(process.lodError) || !(process == currentProcess())
+        || !reader.read(sourceCount) || sourceCount != sources.size())
+        return false;
+
+    for (const std::string& source : sources)
+    {
+        std::string path;
+        SourceStamp baked;
+        if (!reader.readString(path) || path != source
+            || !reader.read(baked.size) || !reader.read(baked.modified) || !reader.read(baked.hash))
+            return false;
+
+        SourceStamp current;
+        if (!statSource(source, current) || current.size != baked.size)
+            return false;
+
+        // a touched but unchanged file keeps the cache
+        if (current.modified != baked.modified && (!hashSource(source, current) || current.hash != baked.hash))
+            return false;
+    }
+
+    std::string bakedMaterials;
+    uint32_t meshCount = 0;
+    if (!reader.readString(bakedMaterials) || !reader.read(meshCount) || !reader.fits(meshCount, minMeshBytes))
+        return false;
+
+    std::vector<Mesh> bakedMeshes;
+    bakedMeshes.reserve(meshCount);
+    for (uint32_t i = 0; i < meshCount; ++i)
+    {
+        std::string materialsInfo;
+        uint32_t faceType = 0;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        if (!reader.readString(materialsInfo) || !reader.read(faceType)
+            || (faceType != uint32_t(FaceType::TRIANGLE) && faceType != uint32_t(FaceType::QUAD))
+            || !reader.read(vertexCount) || !reader.read(indexCount))
+            return false;
+
+        bakedMeshes.push_back(Mesh(materialsInfo, transform));
+        Mesh& mesh = bakedMeshes.back();
+        mesh.faceType = static_cast<FaceType>(faceType);
+
+        std::vector<Core::rdrVertex> vertices;
+        std::vector<unsigned int> indices;
+        uint32_t lodCount = 0;
+        if (!reader.readVertices(vertices, vertexCount) || !reader.readIndices(indices, indexCount)
+            || !inRange(indices, vertices.size()) || !reader.read(lodCount) || !reader.fits(lodCount, minLodBytes))
+            return false;
+
+        std::vector<std::vector<unsigned int>> lods(lodCount);
+        for (std::vector<unsigned int>& lod : lods)
+        {
+            uint32_t lodIndexCount = 0;
+            if (!reader.read(lodIndexCount) || !reader.readIndices(lod, lodIndexCount) || !inRange(lod, vertices.size()))
+                return false;
+        }
+        mesh.setGeometry(std::move(vertices), std::move(indices), std::move(lods));
+    }
+
+    materialsFile = bakedMaterials;
+    meshes = std::move(bakedMeshes);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::string statement = "Mesh cache hit: " + cacheFile + " | " + std::to_string(meshes.size()) + " meshes in "
+        + std::to_string(elapsed.count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
+
+    return true;
+}
+
+bool MeshCache::save(const std::string& cacheFile, const std::vector<std::string>& sources,
+    const std::string& materialsFile, const std::vector<Mesh>& meshes)
+{
+    if (!enabled)
+        return false;
+
+    std::vector<SourceStamp> stamps(sources.size());
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        if (!statSource(sources[i], stamps[i]) || !hashSource(sources[i], stamps[i]))
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::path path(cacheFile);
+    if (path.has_parent_path())
+        std::filesystem::create_directories(path.parent_path(), error);
+
+    // written next to the cache and renamed so a crash never leaves a truncated file behind
+    std::string temporary = cacheFile + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::string statement = "Unable to write mesh cache: " + cacheFile;
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+            return false;
+        }
+
+        file.write(magic, sizeof(magic));
+        write(file, version);
+        ProcessStamp process = currentProcess();
+        write(file, process.optimized);
+        write(file, process.cacheSize);
+        write(file, process.lodCount);
+        write(file, process.lodError);
+        write(file, uint32_t(sources.size()));
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            writeString(file, sources[i]);
+            write(file, stamps[i].size);
+            write(file, stamps[i].modified);
+            write(file, stamps[i].hash);
+        }
+
+        writeString(file, materialsFile);
+        write(file, uint32_t(meshes.size()));
+
+        std::vector<unsigned char> encoded;
+
+        for (const Mesh& mesh : meshes)
+        {
+            writeString(file, mesh.materialsInfo);
+            write(file, uint32_t(mesh.faceType));
+            const std::vector<Core::rdrVertex>& vertices = mesh.getData().getVertices();
+            const std::vector<unsigned int>& indices = mesh.getData().getIndices();
+            write(file, uint32_t(vertices.size()));
+            write(file, uint32_t(indices.size()));
+            MeshCodec::encodeVertices(vertices.data(), vertices.size(), sizeof(Core::rdrVertex), encoded);
+            writeStream(file, encoded);
+            MeshCodec::encodeIndices(indices.data(), indices.size(), encoded);
+            writeStream(file, encoded);
+
+            const std::vector<std::vector<unsigned int>>& lods = mesh.getData().getLods();
+            write(file, uint32_t(lods.size()));
+            for (const std::vector<unsigned int>& lod : lods)
+            {
+                write(file, uint32_t(lod.size()));
+                MeshCodec::encodeIndices(lod.data(), lod.size(), encoded);
+                writeStream(file, encoded);
+            }
+        }
+
+        if (!file.good())
+        {
+            file.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, cacheFile, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,483 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESHCODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "resources/meshcodec.hpp"
+#include "resources/objparser.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Resources;
+
+namespace
+{
+    // a chunk holds 16 elements: a header of 2 bits per byte plane giving the width of its group,
+    // then the groups of the planes one after the other
+    constexpr size_t groupSize = 16;
+    constexpr size_t groupBytes[4] = { 0, 4, 8, 16 };
+
+    inline unsigned char zigzag8(unsigned char delta)
+    {
+        return (unsigned char)((delta << 1) ^ (delta & 0x80 ? 0xFF : 0x00));
+    }
+
+    inline unsigned char unzigzag8(unsigned char value)
+    {
+        return (unsigned char)((value >> 1) ^ (0 - (value & 1)));
+    }
+
+    inline uint32_t zigzag32(uint32_t delta)
+    {
+        return (delta << 1) ^ (delta & 0x80000000u ? 0xFFFFFFFFu : 0u);
+    }
+
+    inline uint32_t unzigzag32(uint32_t value)
+    {
+        return (value >> 1) ^ (0u - (value & 1));
+    }
+
+    // planes[c * 16 + i] is the byte c of the element i of the chunk
+    void writeChunk(const unsigned char* planes, size_t width, std::vector<unsigned char>& encoded)
+    {
+        size_t headerStart = encoded.size();
+        encoded.resize(headerStart + (width + 3) / 4, 0);
+
+        for (size_t c = 0; c < width; ++c)
+        {
+            const unsigned char* group = planes + c * groupSize;
+
+            unsigned char bits = 0;
+            for (size_t i = 0; i < groupSize; ++i)
+                bits |= group[i];
+
+            int code = bits == 0 ? 0 : bits < 4 ? 1 : bits < 16 ? 2 : 3;
+            encoded[headerStart + c / 4] |= (unsigned char)(code << (2 * (c % 4)));
+
+            if (code == 1)
+            {
+                for (size_t i = 0; i < groupSize; i += 4)
+                    encoded.push_back((unsigned char)(group[i] | group[i + 1] << 2 | group[i + 2] << 4 | group[i + 3] << 6));
+            }
+            else if (code == 2)
+            {
+                for (size_t i = 0; i < groupSize; i += 2)
+                    encoded.push_back((unsigned char)(group[i] | group[i + 1] << 4));
+            }
+            else if (code == 3)
+            {
+                encoded.insert(encoded.end(), group, group + groupSize);
+            }
+        }
+    }
+
+#ifdef MESHCODEC_SSE2
+    inline __m128i decodeGroup(const unsigned char* in, int code)
+    {
+        switch (code)
+        {
+        case 1:
+        {
+            // each packed byte spread over 4 lanes, the lane k keeps the bits 2k and 2k + 1
+            int packed;
+            memcpy(&packed, in, sizeof(packed));
+            __m128i bytes = _mm_cvtsi32_si128(packed);
+            bytes = _mm_unpacklo_epi8(bytes, bytes);
+            bytes = _mm_unpacklo_epi16(bytes, bytes);
+
+            __m128i result = _mm_and_si128(bytes, _mm_set1_epi32(0x00000003));
+            result = _mm_or_si128(result, _mm_and_si128(_mm_srli_epi16(bytes, 2), _mm_set1_epi32(0x00000300)));
+            result = _mm_or_si128(result, _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi32(0x00030000)));
+            return _mm_or_si128(result, _mm_and_si128(_mm_srli_epi16(bytes, 6), _mm_set1_epi32(0x03000000)));
+        }
+        case 2:
+        {
+            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+            bytes = _mm_unpacklo_epi8(bytes, bytes);
+
+            __m128i result = _mm_and_si128(bytes, _mm_set1_epi16(0x000F));
+            return _mm_or_si128(result, _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi16(0x0F00)));
+        }
+        case 3:
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        default:
+            return _mm_setzero_si128();
+        }
+    }
+
+    inline __m128i unzigzag8(__m128i value)
+    {
+        __m128i half = _mm_and_si128(_mm_srli_epi16(value, 1), _mm_set1_epi8(0x7F));
+        __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi8(1)));
+        return _mm_xor_si128(half, sign);
+    }
+
+    inline __m128i unzigzag32(__m128i value)
+    {
+        __m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi32(1)));
+        return _mm_xor_si128(_mm_srli_epi32(value, 1), sign);
+    }
+
+    // rows[c] holds the byte c of the 16 elements, afterwards rows[i] holds the 16 bytes of the element i
+    inline void transpose(__m128i rows[16])
+    {
+        __m128i t[16];
+
+        // t[h * 8 + k]: planes 2k and 2k + 1 of the elements h * 8 to h * 8 + 7
+        for (int k = 0; k < 8; ++k)
+        {
+            t[k] = _mm_unpacklo_epi8(rows[2 * k], rows[2 * k + 1]);
+            t[k + 8] = _mm_unpackhi_epi8(rows[2 * k], rows[2 * k + 1]);
+        }
+
+        // rows[q * 4 + m]: planes 4m to 4m + 3 of the elements q * 4 to q * 4 + 3
+        for (int h = 0; h < 2; ++h)
+        {
+            for (int m = 0; m < 4; ++m)
+            {
+                rows[h * 8 + m] = _mm_unpacklo_epi16(t[h * 8 + 2 * m], t[h * 8 + 2 * m + 1]);
+                rows[h * 8 + m + 4] = _mm_unpackhi_epi16(t[h * 8 + 2 * m], t[h * 8 + 2 * m + 1]);
+            }
+        }
+
+        // t[e * 2 + n]: planes 8n to 8n + 7 of the elements 2e and 2e + 1
+        for (int q = 0; q < 4; ++q)
+        {
+            for (int n = 0; n < 2; ++n)
+            {
+                t[q * 4 + n] = _mm_unpacklo_epi32(rows[q * 4 + 2 * n], rows[q * 4 + 2 * n + 1]);
+                t[q * 4 + n + 2] = _mm_unpackhi_epi32(rows[q * 4 + 2 * n], rows[q * 4 + 2 * n + 1]);
+            }
+        }
+
+        for (int e = 0; e < 8; ++e)
+        {
+            rows[2 * e] = _mm_unpacklo_epi64(t[e * 2], t[e * 2 + 1]);
+            rows[2 * e + 1] = _mm_unpackhi_epi64(t[e * 2], t[e * 2 + 1]);
+        }
+    }
+#else
+    inline void decodeGroup(const unsigned char* in, int code, unsigned char* group)
+    {
+        switch (code)
+        {
+        case 1:
+            for (size_t i = 0; i < groupSize; ++i)
+                group[i] = (in[i / 4] >> (2 * (i % 4))) & 0x03;
+            break;
+        case 2:
+            for (size_t i = 0; i < groupSize; ++i)
+                group[i] = (in[i / 2] >> (4 * (i % 2))) & 0x0F;
+            break;
+        case 3:
+            memcpy(group, in, groupSize);
+            break;
+        default:
+            memset(group, 0, groupSize);
+            break;
+        }
+    }
+#endif
+
+    // fills planes as laid out by writeChunk, false when the input is too short
+    bool readChunk(const unsigned char*& in, const unsigned char* end, size_t width, unsigned char* planes)
+    {
+        size_t headerSize = (width + 3) / 4;
+        if (size_t(end - in) < headerSize)
+            return false;
+
+        const unsigned char* header = in;
+        size_t payload = 0;
+        for (size_t c = 0; c < width; ++c)
+            payload += groupBytes[(header[c / 4] >> (2 * (c % 4))) & 3];
+
+        in += headerSize;
+        if (size_t(end - in) < payload)
+            return false;
+
+        for (size_t c = 0; c < width; ++c)
+        {
+            int code = (header[c / 4] >> (2 * (c % 4))) & 3;
+#ifdef MESHCODEC_SSE2
+            _mm_store_si128(reinterpret_cast<__m128i*>(planes + c * groupSize), decodeGroup(in, code));
+#else
+            decodeGroup(in, code, planes + c * groupSize);
+#endif
+            in += groupBytes[code];
+        }
+
+        return true;
+    }
+}
+
+void MeshCodec::encodeVertices(const void* vertices, size_t count, size_t stride, std::vector<unsigned char>& encoded)
+{
+    encoded.clear();
+    if (count == 0 || stride == 0 || stride > maxStride)
+        return;
+
+    encoded.reserve(count * stride / 2);
+
+    const unsigned char* source = static_cast<const unsigned char*>(vertices);
+    unsigned char previous[maxStride] = {};
+    unsigned char planes[maxStride * groupSize];
+
+    for (size_t base = 0; base < count; base += groupSize)
+    {
+        for (size_t i = 0; i < groupSize; ++i)
+        {
+            // the last chunk is padded with copies of the last vertex, zero deltas
+            const unsigned char* vertex = source + std::min(base + i, count - 1) * stride;
+            for (size_t c = 0; c < stride; ++c)
+            {
+                planes[c * groupSize + i] = zigzag8((unsigned char)(vertex[c] - previous[c]));
+                previous[c] = vertex[c];
+            }
+        }
+
+        writeChunk(planes, stride, encoded);
+    }
+}
+
+bool MeshCodec::decodeVertices(void* vertices, size_t count, size_t stride, const unsigned char* encoded, size_t size)
+{
+    if (stride == 0 || stride > maxStride)
+        return false;
+
+    const unsigned char* in = encoded;
+    const unsigned char* end = encoded + size;
+    unsigned char* destination = static_cast<unsigned char*>(vertices);
+
+    alignas(16) unsigned char planes[maxStride * groupSize];
+    alignas(16) unsigned char previous[maxStride] = {};
+    alignas(16) unsigned char tail[maxStride * groupSize];
+
+    for (size_t base = 0; base < count; base += groupSize)
+    {
+        if (!readChunk(in, end, stride, planes))
+            return false;
+
+        size_t elements = std::min(groupSize, count - base);
+        unsigned char* out = elements == groupSize ? destination + base * stride : tail;
+
+#ifdef MESHCODEC_SSE2
+        if (stride % 16 == 0)
+        {
+            // 16 planes at a time: transposed to 16 elements, then summed to the previous vertex
+            for (size_t c = 0; c < stride; c += 16)
+            {
+                __m128i rows[16];
+                for (int r = 0; r < 16; ++r)
+                    rows[r] = _mm_load_si128(reinterpret_cast<const __m128i*>(planes + (c + r) * groupSize));
+
+                transpose(rows);
+
+                __m128i last = _mm_load_si128(reinterpret_cast<const __m128i*>(previous + c));
+                for (int i = 0; i < 16; ++i)
+                {
+                    last = _mm_add_epi8(last, unzigzag8(rows[i]));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * stride + c), last);
+                }
+                _mm_store_si128(reinterpret_cast<__m128i*>(previous + c), last);
+            }
+        }
+        else
+#endif
+        {
+            for (size_t i = 0; i < groupSize; ++i)
+            {
+                for (size_t c = 0; c < stride; ++c)
+                {
+                    previous[c] = (unsigned char)(previous[c] + unzigzag8(planes[c * groupSize + i]));
+                    out[i * stride + c] = previous[c];
+                }
+            }
+        }
+
+        if (out == tail)
+            memcpy(destination + base * stride, tail, elements * stride);
+    }
+
+    return in == end;
+}
+
+void MeshCodec::encodeIndices(const unsigned int* indices, size_t count, std::vector<unsigned char>& encoded)
+{
+    encoded.clear();
+    encoded.reserve(count);
+
+    uint32_t previous = 0;
+    unsigned char planes[4 * groupSize];
+
+    for (size_t base = 0; base < count; base += groupSize)
+    {
+        for (size_t i = 0; i < groupSize; ++i)
+        {
+            uint32_t index = indices[std::min(base + i, count - 1)];
+            uint32_t value = zigzag32(index - previous);
+            previous = index;
+
+            for (size_t c = 0; c < 4; ++c)
+                planes[c * groupSize + i] = (unsigned char)(value >> (8 * c));
+        }
+
+        writeChunk(planes, 4, encoded);
+    }
+}
+
+size_t MeshCodec::maxCount(size_t size, size_t stride)
+{
+    if (stride == 0 || stride > maxStride)
+        return 0;
+
+    return size / ((stride + 3) / 4) * groupSize;
+}
+
+bool MeshCodec::decodeIndices(unsigned int* indices, size_t count, const unsigned char* encoded, size_t size)
+{
+    const unsigned char* in = encoded;
+    const unsigned char* end = encoded + size;
+
+    alignas(16) unsigned char planes[4 * groupSize];
+    alignas(16) uint32_t tail[groupSize];
+
+#ifdef MESHCODEC_SSE2
+    __m128i previous = _mm_setzero_si128();
+#else
+    uint32_t previous = 0;
+#endif
+
+    for (size_t base = 0; base < count; base += groupSize)
+    {
+        if (!readChunk(in, end, 4, planes))
+            return false;
+
+        size_t elements = std::min(groupSize, count - base);
+        uint32_t* out = elements == groupSize ? indices + base : tail;
+
+#ifdef MESHCODEC_SSE2
+        const __m128i* rows = reinterpret_cast<const __m128i*>(planes);
+        __m128i low = _mm_unpacklo_epi8(rows[0], rows[1]);
+        __m128i high = _mm_unpacklo_epi8(rows[2], rows[3]);
+        __m128i values[4] = { _mm_unpacklo_epi16(low, high), _mm_unpackhi_epi16(low, high) };
+        low = _mm_unpackhi_epi8(rows[0], rows[1]);
+        high = _mm_unpackhi_epi8(rows[2], rows[3]);
+        values[2] = _mm_unpacklo_epi16(low, high);
+        values[3] = _mm_unpackhi_epi16(low, high);
+
+        for (int v = 0; v < 4; ++v)
+        {
+            // prefix sum of the 4 deltas, carried from the last index of the previous vector
+            __m128i sum = unzigzag32(values[v]);
+            sum = _mm_add_epi32(sum, _mm_slli_si128(sum, 4));
+            sum = _mm_add_epi32(sum, _mm_slli_si128(sum, 8));
+            sum = _mm_add_epi32(sum, previous);
+            previous = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 3, 3, 3));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + v * 4), sum);
+        }
+#else
+        for (size_t i = 0; i < groupSize; ++i)
+        {
+            uint32_t value = planes[i] | planes[groupSize + i] << 8 | planes[2 * groupSize + i] << 16 | uint32_t(planes[3 * groupSize + i]) << 24;
+            previous += unzigzag32(value);
+            out[i] = previous;
+        }
+#endif
+
+        if (out == tail)
+            memcpy(indices + base, tail, elements * sizeof(uint32_t));
+    }
+
+    return in == end;
+}
+
+void MeshCodec::benchmark(const std::string& directory)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    if (!fs::is_directory(directory, error))
+    {
+        std::string statement = "Mesh codec benchmark: not a directory: " + directory;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return;
+    }
+
+    double totalRaw = 0.0;
+    double totalEncoded = 0.0;
+    double totalMilliseconds = 0.0;
+
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory, error))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".obj")
+            continue;
+
+        // the geometry the mesh cache stores
+        ObjData data;
+        if (!ObjParser::parseFile(entry.path().string(), data))
+            continue;
+        ObjParser::optimize(entry.path().string(), data);
+
+        size_t rawBytes = 0;
+        size_t encodedBytes = 0;
+        double best = 0.0;
+        bool valid = true;
+
+        std::vector<unsigned char> vertexStream;
+        std::vector<unsigned char> indexStream;
+        for (const ObjMesh& mesh : data.meshes)
+        {
+            size_t vertexBytes = mesh.rdrVertices.size() * sizeof(Core::rdrVertex);
+            size_t indexBytes = mesh.indices.size() * sizeof(unsigned int);
+
+            encodeVertices(mesh.rdrVertices.data(), mesh.rdrVertices.size(), sizeof(Core::rdrVertex), vertexStream);
+            encodeIndices(mesh.indices.data(), mesh.indices.size(), indexStream);
+
+            std::vector<Core::rdrVertex> vertices(mesh.rdrVertices.size());
+            std::vector<unsigned int> indices(mesh.indices.size());
+
+            // best of a few runs, the first one also pays the page faults of the outputs
+            double meshBest = 0.0;
+            for (int run = 0; run < 5; ++run)
+            {
+                auto start = std::chrono::steady_clock::now();
+                valid &= decodeVertices(vertices.data(), vertices.size(), sizeof(Core::rdrVertex), vertexStream.data(), vertexStream.size());
+                valid &= decodeIndices(indices.data(), indices.size(), indexStream.data(), indexStream.size());
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+                if (run == 0 || elapsed.count() < meshBest)
+                    meshBest = elapsed.count();
+            }
+
+            valid &= memcmp(vertices.data(), mesh.rdrVertices.data(), vertexBytes) == 0
+                && memcmp(indices.data(), mesh.indices.data(), indexBytes) == 0;
+
+            rawBytes += vertexBytes + indexBytes;
+            encodedBytes += vertexStream.size() + indexStream.size();
+            best += meshBest;
+        }
+
+        double megabytes = double(rawBytes) / (1024.0 * 1024.0);
+        totalRaw += double(rawBytes);
+        totalEncoded += double(encodedBytes);
+        totalMilliseconds += best;
+
+        std::string statement = "Mesh codec benchmark: " + entry.path().filename().string() + " | "
+            + std::to_string(megabytes) + " MB | ratio " + std::to_string(rawBytes > 0 ? double(encodedBytes) / double(rawBytes) : 0.0)
+            + " | decode " + std::to_string(best) + " ms | " + std::to_string(best > 0.0 ? megabytes / (best / 1000.0) : 0.0) + " MB/s"
+            + (valid ? "" : " | MISMATCH");
+        Core::Debug::Log::print(statement, valid ? Core::Debug::LogType::INFO : Core::Debug::LogType::WARNING);
+    }
+
+    double totalMegabytes = totalRaw / (1024.0 * 1024.0);
+    std::string statement = "Mesh codec benchmark total: " + std::to_string(totalMegabytes) + " MB | ratio "
+        + std::to_string(totalRaw > 0.0 ? totalEncoded / totalRaw : 0.0) + " | decode " + std::to_string(totalMilliseconds) + " ms | "
+        + std::to_string(totalMilliseconds > 0.0 ? totalMegabytes / (totalMilliseconds / 1000.0) : 0.0) + " MB/s";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+}
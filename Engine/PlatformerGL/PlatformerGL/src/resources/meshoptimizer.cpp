@@ -0,0 +1,245 @@
+#include <algorithm>
+
+#include "resources/meshoptimizer.hpp"
+#include "core/maths/maths.hpp"
+
+using namespace Resources;
+using namespace Core::Maths;
+
+bool MeshOptimizer::enabled = true;
+unsigned int MeshOptimizer::cacheSize = 16;
+
+namespace
+{
+    // triangles using each vertex, in compressed rows
+    struct Adjacency
+    {
+        Adjacency(const std::vector<unsigned int>& indices, size_t vertexCount)
+            : offsets(vertexCount + 1, 0), triangles(indices.size())
+        {
+            for (unsigned int index : indices)
+                ++offsets[index + 1];
+            for (size_t i = 0; i < vertexCount; ++i)
+                offsets[i + 1] += offsets[i];
+
+            std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i)
+                triangles[cursor[indices[i]]++] = unsigned(i / 3);
+        }
+
+        std::vector<unsigned int> offsets;
+        std::vector<unsigned int> triangles;
+    };
+}
+
+size_t MeshOptimizer::cacheMisses(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+    // a vertex is in the FIFO while fewer than cacheSize misses happened since its own
+    std::vector<size_t> stamps(vertexCount, 0);
+    size_t misses = 0;
+
+    for (unsigned int index : indices)
+    {
+        if (stamps[index] == 0 || misses - stamps[index] >= cacheSize)
+            stamps[index] = ++misses;
+    }
+
+    return misses;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+        return;
+
+    Adjacency adjacency(indices, vertexCount);
+
+    std::vector<unsigned int> liveTriangles(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+        liveTriangles[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    unsigned int time = cacheSize + 1;
+    size_t cursor = 0;
+    long long fanning = 0;
+
+    while (fanning >= 0)
+    {
+        // emits every remaining triangle around the fanning vertex
+        candidates.clear();
+        unsigned int vertex = unsigned(fanning);
+        for (unsigned int i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i)
+        {
+            unsigned int triangle = adjacency.triangles[i];
+            if (emitted[triangle])
+                continue;
+
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int index = indices[size_t(triangle) * 3 + corner];
+                output.push_back(index);
+                deadEnd.push_back(index);
+                candidates.push_back(index);
+                --liveTriangles[index];
+
+                if (time - cacheTime[index] > cacheSize)
+                    cacheTime[index] = time++;
+            }
+            emitted[triangle] = 1;
+        }
+
+        // next fanning vertex: the one still in cache that will stay there the longest
+        fanning = -1;
+        int best = -1;
+        for (unsigned int candidate : candidates)
+        {
+            if (liveTriangles[candidate] == 0)
+                continue;
+
+            int priority = 0;
+            if (time - cacheTime[candidate] + 2 * liveTriangles[candidate] <= cacheSize)
+                priority = int(time - cacheTime[candidate]);
+            if (priority > best)
+            {
+                best = priority;
+                fanning = candidate;
+            }
+        }
+
+        // dead end: most recent vertex with triangles left, otherwise the next one in input order
+        while (fanning < 0 && !deadEnd.empty())
+        {
+            unsigned int candidate = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[candidate] > 0)
+                fanning = candidate;
+        }
+        while (fanning < 0 && cursor < vertexCount)
+        {
+            if (liveTriangles[cursor] > 0)
+                fanning = (long long)cursor;
+            ++cursor;
+        }
+    }
+
+    indices = std::move(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Core::rdrVertex>& vertices, unsigned int cacheSize)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // clusters start where the cache restarts (3 misses), moving them around keeps the ACMR
+    std::vector<size_t> clusters;
+    std::vector<size_t> stamps(vertices.size(), 0);
+    size_t misses = 0;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        int triangleMisses = 0;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int index = indices[triangle * 3 + corner];
+            if (stamps[index] == 0 || misses - stamps[index] >= cacheSize)
+            {
+                stamps[index] = ++misses;
+                ++triangleMisses;
+            }
+        }
+
+        if (triangle == 0 || triangleMisses == 3)
+            clusters.push_back(triangle);
+    }
+    clusters.push_back(triangleCount);
+
+    if (clusters.size() <= 2)
+        return;
+
+    auto position = [&vertices](unsigned int index) { return vec3{ vertices[index].x, vertices[index].y, vertices[index].z }; };
+
+    vec3 meshCentroid = { 0.f, 0.f, 0.f };
+    for (unsigned int index : indices)
+        meshCentroid += position(index);
+    meshCentroid = meshCentroid / float(indices.size());
+
+    // clusters facing away from the center are drawn first, they tend to hide the others
+    std::vector<float> sortKeys(clusters.size() - 1);
+    for (size_t cluster = 0; cluster + 1 < clusters.size(); ++cluster)
+    {
+        vec3 centroid = { 0.f, 0.f, 0.f };
+        vec3 normal = { 0.f, 0.f, 0.f };
+        float area = 0.f;
+        for (size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+        {
+            vec3 a = position(indices[triangle * 3]);
+            vec3 b = position(indices[triangle * 3 + 1]);
+            vec3 c = position(indices[triangle * 3 + 2]);
+
+            vec3 areaNormal = vectProduct(b - a, c - a);
+            float triangleArea = mag(areaNormal);
+
+            centroid += (a + b + c) * (triangleArea / 3.f);
+            normal += areaNormal;
+            area += triangleArea;
+        }
+
+        if (area > 0.f)
+            centroid = centroid / area;
+        float length = mag(normal);
+        if (length > 0.f)
+            normal = normal / length;
+
+        sortKeys[cluster] = dot(centroid - meshCentroid, normal);
+    }
+
+    std::vector<size_t> order(sortKeys.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (size_t cluster : order)
+        output.insert(output.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + clusters[cluster + 1] * 3);
+
+    indices = std::move(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Core::rdrVertex>& vertices, std::vector<unsigned int>& indices)
+{
+    std::vector<unsigned int> remap(vertices.size(), ~0u);
+    std::vector<Core::rdrVertex> output;
+    output.reserve(vertices.size());
+
+    for (unsigned int& index : indices)
+    {
+        if (remap[index] == ~0u)
+        {
+            remap[index] = unsigned(output.size());
+            output.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices = std::move(output);
+}
+
+void MeshOptimizer::optimize(std::vector<Core::rdrVertex>& vertices, std::vector<unsigned int>& indices,
+    size_t& missesBefore, size_t& missesAfter)
+{
+    missesBefore = cacheMisses(indices, vertices.size(), cacheSize);
+
+    optimizeVertexCache(indices, vertices.size(), cacheSize);
+    optimizeOverdraw(indices, vertices, cacheSize);
+    optimizeVertexFetch(vertices, indices);
+
+    missesAfter = cacheMisses(indices, vertices.size(), cacheSize);
+}
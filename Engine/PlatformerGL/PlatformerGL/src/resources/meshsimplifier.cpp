@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#include "resources/meshsimplifier.hpp"
+#include "resources/meshoptimizer.hpp"
+#include "core/maths/maths.hpp"
+
+using namespace Resources;
+using namespace Core::Maths;
+
+bool MeshSimplifier::enabled = true;
+int MeshSimplifier::lodCount = 3;
+float MeshSimplifier::maxError = 0.04f;
+
+namespace
+{
+    // symmetric 4x4 matrix of the squared distances to the planes around a vertex, weighted by area
+    struct Quadric
+    {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+        double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+        double a22 = 0.0, a23 = 0.0;
+        double a33 = 0.0;
+        double weight = 0.0;
+
+        void addPlane(double a, double b, double c, double d, double w)
+        {
+            a00 += w * a * a; a01 += w * a * b; a02 += w * a * c; a03 += w * a * d;
+            a11 += w * b * b; a12 += w * b * c; a13 += w * b * d;
+            a22 += w * c * c; a23 += w * c * d;
+            a33 += w * d * d;
+            weight += w;
+        }
+
+        void add(const Quadric& q)
+        {
+            a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+            a11 += q.a11; a12 += q.a12; a13 += q.a13;
+            a22 += q.a22; a23 += q.a23;
+            a33 += q.a33;
+            weight += q.weight;
+        }
+
+        // mean squared distance of the point to the planes
+        double error(double x, double y, double z) const
+        {
+            double e = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+                + a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+                + a22 * z * z + 2.0 * a23 * z
+                + a33;
+
+            return weight > 0.0 ? std::fabs(e) / weight : 0.0;
+        }
+    };
+
+    struct PositionKey
+    {
+        uint32_t x, y, z;
+
+        bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+    };
+
+    struct PositionHash
+    {
+        size_t operator()(const PositionKey& key) const
+        {
+            return size_t(key.x * 73856093u ^ key.y * 19349663u ^ key.z * 83492791u);
+        }
+    };
+
+    PositionKey positionKey(const Core::rdrVertex& vertex)
+    {
+        PositionKey key;
+        std::memcpy(&key.x, &vertex.x, sizeof(float));
+        std::memcpy(&key.y, &vertex.y, sizeof(float));
+        std::memcpy(&key.z, &vertex.z, sizeof(float));
+        return key;
+    }
+
+    vec3 position(const Core::rdrVertex& vertex)
+    {
+        return { vertex.x, vertex.y, vertex.z };
+    }
+
+    struct Collapse
+    {
+        unsigned int    from;
+        unsigned int    to;
+        double          error;
+    };
+
+    // seam vertices share their position with another vertex, border vertices have an edge used by a single triangle
+    std::vector<char> lockedVertices(const std::vector<Core::rdrVertex>& vertices, const std::vector<unsigned int>& indices)
+    {
+        std::vector<unsigned int> groups(vertices.size());
+        std::vector<unsigned int> groupSizes;
+        std::unordered_map<PositionKey, unsigned int, PositionHash> positions;
+        positions.reserve(vertices.size());
+
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            auto inserted = positions.emplace(positionKey(vertices[i]), unsigned(groupSizes.size()));
+            if (inserted.second)
+                groupSizes.push_back(0);
+
+            groups[i] = inserted.first->second;
+            ++groupSizes[groups[i]];
+        }
+
+        std::vector<char> lockedGroups(groupSizes.size(), 0);
+        for (size_t group = 0; group < groupSizes.size(); ++group)
+            lockedGroups[group] = groupSizes[group] > 1;
+
+        std::unordered_map<uint64_t, unsigned int> edges;
+        edges.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                uint64_t a = groups[indices[i + corner]];
+                uint64_t b = groups[indices[i + (corner + 1) % 3]];
+                ++edges[a < b ? (a << 32 | b) : (b << 32 | a)];
+            }
+        }
+
+        for (const auto& edge : edges)
+        {
+            // open border or non manifold edge
+            if (edge.second != 2)
+            {
+                lockedGroups[size_t(edge.first >> 32)] = 1;
+                lockedGroups[size_t(edge.first & 0xffffffffu)] = 1;
+            }
+        }
+
+        std::vector<char> locked(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+            locked[i] = lockedGroups[groups[i]];
+
+        return locked;
+    }
+
+    // moving the vertex onto the target must not turn any of its remaining triangles over
+    bool flipsTriangles(const std::vector<Core::rdrVertex>& vertices, const std::vector<unsigned int>& indices,
+        const std::vector<unsigned int>& offsets, const std::vector<unsigned int>& triangles, unsigned int from, unsigned int to)
+    {
+        for (unsigned int i = offsets[from]; i < offsets[from + 1]; ++i)
+        {
+            const unsigned int* triangle = &indices[size_t(triangles[i]) * 3];
+            if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                continue;
+
+            vec3 corners[3];
+            vec3 moved[3];
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                corners[corner] = position(vertices[triangle[corner]]);
+                moved[corner] = triangle[corner] == from ? position(vertices[to]) : corners[corner];
+            }
+
+            vec3 before = vectProduct(corners[1] - corners[0], corners[2] - corners[0]);
+            vec3 after = vectProduct(moved[1] - moved[0], moved[2] - moved[0]);
+            if (dot(before, after) <= 0.f)
+                return true;
+        }
+
+        return false;
+    }
+}
+
+std::vector<unsigned int> MeshSimplifier::simplify(const std::vector<Core::rdrVertex>& vertices, const std::vector<unsigned int>& source,
+    size_t targetIndexCount, float targetError, float* resultError)
+{
+    std::vector<unsigned int> indices = source;
+    if (resultError)
+        *resultError = 0.f;
+    if (indices.size() <= targetIndexCount || vertices.empty())
+        return indices;
+
+    vec3 min = position(vertices[0]);
+    vec3 max = min;
+    for (const Core::rdrVertex& vertex : vertices)
+    {
+        min = { std::min(min.x, vertex.x), std::min(min.y, vertex.y), std::min(min.z, vertex.z) };
+        max = { std::max(max.x, vertex.x), std::max(max.y, vertex.y), std::max(max.z, vertex.z) };
+    }
+    double extent = std::max(max.x - min.x, std::max(max.y - min.y, max.z - min.z));
+    if (extent <= 0.0)
+        return indices;
+
+    double errorLimit = double(targetError) * extent;
+    errorLimit *= errorLimit;
+
+    std::vector<char> locked = lockedVertices(vertices, indices);
+
+    std::vector<Quadric> quadrics(vertices.size());
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        vec3 p0 = position(vertices[indices[i]]);
+        vec3 normal = vectProduct(position(vertices[indices[i + 1]]) - p0, position(vertices[indices[i + 2]]) - p0);
+        float length = mag(normal);
+        if (length <= 0.f)
+            continue;
+
+        normal = normal / length;
+        double d = -double(dot(normal, p0));
+        for (int corner = 0; corner < 3; ++corner)
+            quadrics[indices[i + corner]].addPlane(normal.x, normal.y, normal.z, d, length * 0.5);
+    }
+
+    double reachedError = 0.0;
+    std::vector<unsigned int> offsets(vertices.size() + 1);
+    std::vector<unsigned int> triangles;
+    std::vector<Collapse> collapses;
+    std::vector<char> touched(vertices.size());
+    std::vector<unsigned int> remap(vertices.size());
+
+    while (indices.size() > targetIndexCount)
+    {
+        // triangles around each vertex
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (unsigned int index : indices)
+            ++offsets[index + 1];
+        for (size_t i = 0; i < vertices.size(); ++i)
+            offsets[i + 1] += offsets[i];
+
+        triangles.resize(indices.size());
+        std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            triangles[cursor[indices[i]]++] = unsigned(i / 3);
+
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int a = indices[i + corner];
+                unsigned int b = indices[i + (corner + 1) % 3];
+                for (int direction = 0; direction < 2; ++direction, std::swap(a, b))
+                {
+                    if (locked[a])
+                        continue;
+
+                    Quadric quadric = quadrics[a];
+                    quadric.add(quadrics[b]);
+                    collapses.push_back({ a, b, quadric.error(vertices[b].x, vertices[b].y, vertices[b].z) });
+                }
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        // independent collapses only, their neighbourhoods must not overlap within a pass
+        std::fill(touched.begin(), touched.end(), 0);
+        for (size_t i = 0; i < remap.size(); ++i)
+            remap[i] = unsigned(i);
+
+        size_t removed = 0;
+        size_t toRemove = (indices.size() - targetIndexCount) / 3;
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.error > errorLimit || removed >= toRemove)
+                break;
+            if (touched[collapse.from] || touched[collapse.to]
+                || flipsTriangles(vertices, indices, offsets, triangles, collapse.from, collapse.to))
+                continue;
+
+            for (unsigned int i = offsets[collapse.from]; i < offsets[collapse.from + 1]; ++i)
+            {
+                const unsigned int* triangle = &indices[size_t(triangles[i]) * 3];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                    ++removed;
+
+                touched[triangle[0]] = 1;
+                touched[triangle[1]] = 1;
+                touched[triangle[2]] = 1;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            reachedError = std::max(reachedError, collapse.error);
+        }
+
+        if (removed == 0)
+            break;
+
+        size_t write = 0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            unsigned int a = remap[indices[i]];
+            unsigned int b = remap[indices[i + 1]];
+            unsigned int c = remap[indices[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+
+            indices[write++] = a;
+            indices[write++] = b;
+            indices[write++] = c;
+        }
+        indices.resize(write);
+    }
+
+    if (resultError)
+        *resultError = float(std::sqrt(reachedError) / extent);
+
+    return indices;
+}
+
+std::vector<std::vector<unsigned int>> MeshSimplifier::buildLods(const std::vector<Core::rdrVertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    std::vector<std::vector<unsigned int>> lods;
+
+    for (int level = 1; level <= lodCount; ++level)
+    {
+        const std::vector<unsigned int>& previous = lods.empty() ? indices : lods.back();
+        size_t target = previous.size() / 6 * 3;
+
+        // the allowed error doubles with each level up to maxError
+        float error = maxError / float(1 << (lodCount - level));
+        std::vector<unsigned int> lod = simplify(vertices, previous, target, error);
+        if (lod.empty() || lod.size() * 5 > previous.size() * 4)
+            break;
+
+        if (MeshOptimizer::enabled)
+            MeshOptimizer::optimizeVertexCache(lod, vertices.size(), MeshOptimizer::cacheSize);
+
+        lods.push_back(std::move(lod));
+    }
+
+    return lods;
+}
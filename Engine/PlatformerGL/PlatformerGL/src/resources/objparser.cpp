@@ -0,0 +1,903 @@
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include <thread>
+
+#include "resources/objparser.hpp"
+#include "resources/meshoptimizer.hpp"
+#include "resources/meshsimplifier.hpp"
+#include "core/io/mappedfile.hpp"
+#include "core/io/assetpack.hpp"
+#include "core/datastructure/threadpool.hpp"
+#include "core/debug/log.hpp"
+#include "core/debug/loadprofiler.hpp"
+
+using namespace Resources;
+using namespace Core::Maths;
+
+bool ObjParser::parallelEnabled = true;
+size_t ObjParser::parallelThreshold = 4 * 1024 * 1024;
+
+namespace
+{
+    struct FaceCorner
+    {
+        int position;
+        int texCoord;
+        int normal;
+    };
+
+    inline bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline const char* skipBlanks(const char* p, const char* end)
+    {
+        while (p < end && isBlank(*p))
+            ++p;
+        return p;
+    }
+
+    inline bool parseFloat(const char*& p, const char* end, float& value)
+    {
+        p = skipBlanks(p, end);
+        if (p < end && *p == '+')
+            ++p;
+
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+            return false;
+
+        p = result.ptr;
+        return true;
+    }
+
+    inline bool parseInt(const char*& p, const char* end, int& value)
+    {
+        if (p < end && *p == '+')
+            ++p;
+
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+            return false;
+
+        p = result.ptr;
+        return true;
+    }
+
+    // OBJ indices are 1-based, negative values are relative to the end of the list
+    inline int resolveIndex(int index, size_t count)
+    {
+        if (index > 0)
+            return index - 1 < int(count) ? index - 1 : -1;
+        if (index < 0)
+            return int(count) + index >= 0 ? int(count) + index : -1;
+        return -1;
+    }
+
+    // "v", "v/vt", "v//vn" or "v/vt/vn"
+    inline bool parseCorner(const char*& p, const char* end, FaceCorner& corner)
+    {
+        corner = { 0, 0, 0 };
+        if (!parseInt(p, end, corner.position))
+            return false;
+
+        if (p < end && *p == '/')
+        {
+            ++p;
+            if (p < end && *p != '/' && !parseInt(p, end, corner.texCoord))
+                return false;
+
+            if (p < end && *p == '/')
+            {
+                ++p;
+                if (!parseInt(p, end, corner.normal))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    inline std::string_view trimmed(const char* begin, const char* end)
+    {
+        begin = skipBlanks(begin, end);
+        while (end > begin && isBlank(end[-1]))
+            --end;
+        return std::string_view(begin, size_t(end - begin));
+    }
+
+    inline bool startsWith(std::string_view line, const char* keyword)
+    {
+        size_t length = std::strlen(keyword);
+        return line.size() > length && line.compare(0, length, keyword) == 0 && isBlank(line[length]);
+    }
+
+    const float cornerColors[4][3] = {
+        { 1.f, 0.f, 0.f },
+        { 0.f, 1.f, 0.f },
+        { 0.f, 0.f, 1.f },
+        { 0.f, 0.f, 1.f }
+    };
+
+    inline const float* cornerColor(size_t corner)
+    {
+        return cornerColors[corner < 3 ? corner : 3];
+    }
+
+    // fan triangulation of a face whose corners start at first
+    inline void pushFan(std::vector<unsigned int>& indices, unsigned int first, size_t cornerCount)
+    {
+        for (unsigned int i = 1; i + 1 < cornerCount; ++i)
+        {
+            indices.push_back(first);
+            indices.push_back(first + i);
+            indices.push_back(first + i + 1);
+        }
+    }
+
+    // open addressing table from vertex content to its welded index
+    struct WeldTable
+    {
+        std::vector<unsigned int>   slots;
+        size_t                      mask = 0;
+
+        WeldTable(size_t count)
+        {
+            size_t capacity = 16;
+            while (capacity < count * 2)
+                capacity *= 2;
+
+            slots.assign(capacity, ~0u);
+            mask = capacity - 1;
+        }
+
+        // position, normal and uv only: the per corner color is not read by any shader
+        static bool same(const Core::rdrVertex& a, const Core::rdrVertex& b)
+        {
+            return std::memcmp(&a.x, &b.x, 3 * sizeof(float)) == 0
+                && std::memcmp(&a.nx, &b.nx, 5 * sizeof(float)) == 0;
+        }
+
+        static size_t hash(const Core::rdrVertex& vertex)
+        {
+            const float values[8] = { vertex.x, vertex.y, vertex.z, vertex.nx, vertex.ny, vertex.nz, vertex.u, vertex.v };
+            uint32_t words[8];
+            std::memcpy(words, values, sizeof(words));
+
+            uint64_t hash = 0;
+            for (uint32_t word : words)
+                hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+            return size_t(hash ^ (hash >> 32));
+        }
+    };
+
+    // records that change how faces are grouped into meshes, placed by the number of faces before them
+    struct ObjEvent
+    {
+        enum class Type
+        {
+            MTLLIB,
+            USEMTL,
+            VERTICES
+        };
+
+        Type        type;
+        size_t      faceIndex;
+        std::string name;
+    };
+
+    // a face as read from the text: raw OBJ indices plus the list sizes at that line
+    struct FaceRecord
+    {
+        unsigned int    cornerCount;    // 0 when the face is malformed
+        unsigned int    vertexCount;
+        unsigned int    texCoordCount;
+        unsigned int    normalCount;
+    };
+
+    // run of consecutive faces of one chunk that belong to the same mesh
+    struct ObjSegment
+    {
+        size_t                          mesh;
+        size_t                          faceBegin;
+        size_t                          faceEnd;
+        std::vector<Core::rdrVertex>    rdrVertices;
+        std::vector<unsigned int>       indices;
+        bool                            hasFaces = false;
+        FaceType                        faceType = FaceType::TRIANGLE;
+    };
+
+    struct ObjChunk
+    {
+        const char*                 begin;
+        const char*                 end;
+
+        std::vector<vec3>           vertices;
+        std::vector<vec2>           texCoords;
+        std::vector<vec3>           normals;
+        std::vector<FaceCorner>     corners;
+        std::vector<FaceRecord>     faces;
+        std::vector<ObjEvent>       events;
+
+        size_t                      vertexOffset = 0;
+        size_t                      texCoordOffset = 0;
+        size_t                      normalOffset = 0;
+        std::vector<ObjSegment>     segments;
+        int                         skippedFaces = 0;
+    };
+
+    void tokenizeChunk(ObjChunk& chunk)
+    {
+        const char* p = chunk.begin;
+        const char* end = chunk.end;
+        size_t estimate = size_t(end - p) / 64;
+        chunk.vertices.reserve(estimate);
+        chunk.texCoords.reserve(estimate);
+        chunk.normals.reserve(estimate);
+        chunk.faces.reserve(estimate);
+        chunk.corners.reserve(estimate * 3);
+
+        while (p < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+            if (!lineEnd)
+                lineEnd = end;
+
+            const char* lineStart = skipBlanks(p, lineEnd);
+            p = lineEnd + 1;
+
+            if (lineEnd - lineStart < 2)
+                continue;
+
+            const char c0 = lineStart[0];
+            const char c1 = lineStart[1];
+
+            if (c0 == 'v')
+            {
+                const char* cursor = lineStart + 2;
+                const bool hasThirdChar = lineEnd - lineStart > 2;
+                vec3 in = { 0.f, 0.f, 0.f };
+                if (isBlank(c1))
+                {
+                    if (chunk.events.empty() || chunk.events.back().type != ObjEvent::Type::VERTICES
+                        || chunk.events.back().faceIndex != chunk.faces.size())
+                        chunk.events.push_back({ ObjEvent::Type::VERTICES, chunk.faces.size(), std::string() });
+
+                    if (parseFloat(cursor, lineEnd, in.x) && parseFloat(cursor, lineEnd, in.y) && parseFloat(cursor, lineEnd, in.z))
+                        chunk.vertices.push_back(in);
+                }
+                else if (c1 == 't' && hasThirdChar && isBlank(lineStart[2]))
+                {
+                    ++cursor;
+                    if (parseFloat(cursor, lineEnd, in.x) && parseFloat(cursor, lineEnd, in.y))
+                        chunk.texCoords.push_back(in.xy);
+                }
+                else if (c1 == 'n' && hasThirdChar && isBlank(lineStart[2]))
+                {
+                    ++cursor;
+                    if (parseFloat(cursor, lineEnd, in.x) && parseFloat(cursor, lineEnd, in.y) && parseFloat(cursor, lineEnd, in.z))
+                        chunk.normals.push_back(in);
+                }
+            }
+            else if (c0 == 'f' && isBlank(c1))
+            {
+                FaceRecord face = { 0, unsigned(chunk.vertices.size()), unsigned(chunk.texCoords.size()), unsigned(chunk.normals.size()) };
+                size_t firstCorner = chunk.corners.size();
+
+                const char* cursor = lineStart + 2;
+                unsigned int cornerCount = 0;
+                bool valid = true;
+                while (valid)
+                {
+                    cursor = skipBlanks(cursor, lineEnd);
+                    if (cursor >= lineEnd)
+                        break;
+
+                    FaceCorner corner;
+                    valid = parseCorner(cursor, lineEnd, corner) && corner.position != 0;
+                    chunk.corners.push_back(corner);
+                    ++cornerCount;
+                }
+
+                if (!valid || cornerCount < 3)
+                    chunk.corners.resize(firstCorner);
+                else
+                    face.cornerCount = cornerCount;
+
+                chunk.faces.push_back(face);
+            }
+            else if (c0 == 'u' || c0 == 'm')
+            {
+                std::string_view line = trimmed(lineStart, lineEnd);
+                if (startsWith(line, "mtllib"))
+                {
+                    std::string_view file = trimmed(line.data() + 6, line.data() + line.size());
+                    size_t slash = file.find_last_of("/\\");
+                    if (slash != std::string_view::npos)
+                        file.remove_prefix(slash + 1);
+
+                    chunk.events.push_back({ ObjEvent::Type::MTLLIB, chunk.faces.size(), std::string(file) });
+                }
+                else if (startsWith(line, "usemtl"))
+                {
+                    std::string name(trimmed(line.data() + 6, line.data() + line.size()));
+                    chunk.events.push_back({ ObjEvent::Type::USEMTL, chunk.faces.size(), name });
+                }
+            }
+        }
+    }
+
+    void assembleChunk(ObjChunk& chunk, const std::vector<vec3>& vertices, const std::vector<vec2>& texCoords,
+        const std::vector<vec3>& normals)
+    {
+        size_t corner = 0;
+        size_t face = 0;
+
+        for (ObjSegment& segment : chunk.segments)
+        {
+            for (; face < segment.faceBegin; ++face)
+                corner += chunk.faces[face].cornerCount;
+
+            size_t cornerTotal = 0;
+            for (size_t i = segment.faceBegin; i < segment.faceEnd; ++i)
+                cornerTotal += chunk.faces[i].cornerCount;
+            segment.rdrVertices.reserve(cornerTotal);
+            segment.indices.reserve(cornerTotal * 3 / 2);
+            std::vector<FaceCorner> resolved;
+
+            for (; face < segment.faceEnd; ++face)
+            {
+                const FaceRecord& record = chunk.faces[face];
+                const FaceCorner* corners = &chunk.corners[corner];
+                corner += record.cornerCount;
+
+                if (record.cornerCount == 0)
+                {
+                    ++chunk.skippedFaces;
+                    continue;
+                }
+
+                resolved.resize(record.cornerCount);
+                bool valid = true;
+                for (unsigned int i = 0; i < record.cornerCount && valid; ++i)
+                {
+                    resolved[i].position = resolveIndex(corners[i].position, chunk.vertexOffset + record.vertexCount);
+                    resolved[i].texCoord = corners[i].texCoord == 0 ? -2 : resolveIndex(corners[i].texCoord, chunk.texCoordOffset + record.texCoordCount);
+                    resolved[i].normal = corners[i].normal == 0 ? -2 : resolveIndex(corners[i].normal, chunk.normalOffset + record.normalCount);
+                    valid = resolved[i].position >= 0 && resolved[i].texCoord != -1 && resolved[i].normal != -1;
+                }
+
+                if (!valid)
+                {
+                    ++chunk.skippedFaces;
+                    continue;
+                }
+
+                segment.hasFaces = true;
+                segment.faceType = record.cornerCount == 3 ? FaceType::TRIANGLE : FaceType::QUAD;
+
+                pushFan(segment.indices, unsigned(segment.rdrVertices.size()), record.cornerCount);
+
+                for (unsigned int i = 0; i < record.cornerCount; ++i)
+                {
+                    const vec3& vertex = vertices[resolved[i].position];
+                    vec2 texCoord = resolved[i].texCoord >= 0 ? texCoords[resolved[i].texCoord] : vec2{ 0.f, 0.f };
+                    vec3 normal = resolved[i].normal >= 0 ? normals[resolved[i].normal] : vec3{ 0.f, 0.f, 0.f };
+                    const float* color = cornerColor(i);
+
+                    segment.rdrVertices.push_back(Core::rdrVertex{
+                        vertex.x, vertex.y, vertex.z,
+                        color[0], color[1], color[2], 1.f,
+                        normal.x, normal.y, normal.z,
+                        texCoord.x, texCoord.y,
+                        });
+                }
+            }
+        }
+    }
+}
+
+bool ObjParser::parseFile(const std::string& filename, ObjData& data)
+{
+    Core::IO::AssetFile file;
+    if (!file.open(filename))
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    parse(file.data(), file.size(), data);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    double megabytes = double(file.size()) / (1024.0 * 1024.0);
+    double throughput = elapsed.count() > 0.0 ? megabytes / (elapsed.count() / 1000.0) : 0.0;
+    std::string statement = "OBJ parsed: " + filename + " | " + std::to_string(megabytes) + " MB in "
+        + std::to_string(elapsed.count()) + " ms (" + std::to_string(throughput) + " MB/s)";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
+    Core::Debug::LoadProfiler::getInstance().record(Core::Debug::LoadStage::OBJ_PARSE, filename, elapsed.count(), file.size());
+
+    size_t vertices = 0;
+    size_t corners = 0;
+    for (const ObjMesh& mesh : data.meshes)
+    {
+        vertices += mesh.rdrVertices.size();
+        corners += mesh.indices.size();
+    }
+
+    // before welding every triangle corner was its own vertex with a 0..N-1 index
+    if (vertices > 0)
+    {
+        size_t triangles = corners / 3;
+        size_t before = corners * (sizeof(Core::rdrVertex) + sizeof(unsigned int));
+        size_t after = vertices * sizeof(Core::rdrVertex) + corners * sizeof(unsigned int);
+        statement = "OBJ import: " + filename + " | " + std::to_string(triangles) + " triangles, "
+            + std::to_string(corners) + " corners -> " + std::to_string(vertices) + " vertices ("
+            + std::to_string(double(corners) / double(vertices)) + "x), geometry "
+            + std::to_string(before / 1024) + " KB -> " + std::to_string(after / 1024) + " KB";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+    }
+
+    return true;
+}
+
+void ObjParser::optimize(const std::string& filename, ObjData& data)
+{
+    if (!MeshOptimizer::enabled)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<size_t> missesBefore(data.meshes.size(), 0);
+    std::vector<size_t> missesAfter(data.meshes.size(), 0);
+    Core::DataStructure::ThreadPool::getInstance().parallelFor(data.meshes.size(), [&](size_t i)
+    {
+        ObjMesh& mesh = data.meshes[i];
+        MeshOptimizer::optimize(mesh.rdrVertices, mesh.indices, missesBefore[i], missesAfter[i]);
+    });
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t triangles = 0;
+    for (size_t i = 0; i < data.meshes.size(); ++i)
+    {
+        triangles += data.meshes[i].indices.size() / 3;
+        data.cacheMissesBefore += missesBefore[i];
+        data.cacheMissesAfter += missesAfter[i];
+    }
+    Core::Debug::LoadProfiler::getInstance().record(Core::Debug::LoadStage::MESH_OPTIMIZE, filename, elapsed.count(),
+        triangles * 3 * sizeof(unsigned int));
+
+    if (triangles > 0)
+    {
+        std::string statement = "Vertex cache: " + filename + " | ACMR " + std::to_string(double(data.cacheMissesBefore) / double(triangles))
+            + " -> " + std::to_string(double(data.cacheMissesAfter) / double(triangles))
+            + " (cache of " + std::to_string(MeshOptimizer::cacheSize) + ") in " + std::to_string(elapsed.count()) + " ms";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+    }
+}
+
+void ObjParser::buildLods(const std::string& filename, ObjData& data)
+{
+    if (!MeshSimplifier::enabled)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    Core::DataStructure::ThreadPool::getInstance().parallelFor(data.meshes.size(), [&data](size_t i)
+    {
+        ObjMesh& mesh = data.meshes[i];
+        mesh.lods = MeshSimplifier::buildLods(mesh.rdrVertices, mesh.indices);
+    });
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t triangles = 0;
+    std::vector<size_t> lodTriangles;
+    for (const ObjMesh& mesh : data.meshes)
+    {
+        triangles += mesh.indices.size() / 3;
+        for (size_t level = 0; level < mesh.lods.size(); ++level)
+        {
+            if (lodTriangles.size() <= level)
+                lodTriangles.push_back(0);
+            lodTriangles[level] += mesh.lods[level].size() / 3;
+        }
+    }
+    Core::Debug::LoadProfiler::getInstance().record(Core::Debug::LoadStage::MESH_LODS, filename, elapsed.count(),
+        triangles * 3 * sizeof(unsigned int));
+
+    if (!lodTriangles.empty())
+    {
+        std::string statement = "LODs: " + filename + " | " + std::to_string(triangles) + " triangles";
+        for (size_t count : lodTriangles)
+            statement += " -> " + std::to_string(count);
+        statement += " in " + std::to_string(elapsed.count()) + " ms";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+    }
+}
+
+void ObjParser::parse(const char* text, size_t size, ObjData& data)
+{
+    // on a single core the chunk bookkeeping only adds work
+    if (parallelEnabled && size >= parallelThreshold && std::thread::hardware_concurrency() > 1)
+        parseParallel(text, size, data);
+    else
+        parseSerial(text, size, data);
+
+    Core::DataStructure::ThreadPool::getInstance().parallelFor(data.meshes.size(), [&data](size_t i)
+    {
+        weld(data.meshes[i]);
+    });
+}
+
+void ObjParser::weld(ObjMesh& mesh)
+{
+    std::vector<Core::rdrVertex> corners = std::move(mesh.rdrVertices);
+    WeldTable table(corners.size());
+    std::vector<unsigned int> remap(corners.size());
+
+    mesh.rdrVertices.clear();
+    mesh.rdrVertices.reserve(corners.size() / 2);
+
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        const Core::rdrVertex& corner = corners[i];
+        size_t slot = WeldTable::hash(corner) & table.mask;
+        while (table.slots[slot] != ~0u && !WeldTable::same(mesh.rdrVertices[table.slots[slot]], corner))
+            slot = (slot + 1) & table.mask;
+
+        if (table.slots[slot] == ~0u)
+        {
+            table.slots[slot] = unsigned(mesh.rdrVertices.size());
+            mesh.rdrVertices.push_back(corner);
+        }
+        remap[i] = table.slots[slot];
+    }
+
+    for (unsigned int& index : mesh.indices)
+        index = remap[index];
+
+    mesh.rdrVertices.shrink_to_fit();
+}
+
+void ObjParser::parseSerial(const char* text, size_t size, ObjData& data)
+{
+    std::vector<vec3> vertices;
+    std::vector<vec2> texCoords;
+    std::vector<vec3> normals;
+
+    // rough guess of the record count so the vectors rarely reallocate
+    vertices.reserve(size / 64);
+    texCoords.reserve(size / 64);
+    normals.reserve(size / 64);
+
+    bool hasMTL = false;
+    int faceCount = 0;
+    int skippedFaces = 0;
+
+    std::vector<FaceCorner> corners;
+    const char* p = text;
+    const char* end = text + size;
+
+    while (p < end)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        if (!lineEnd)
+            lineEnd = end;
+
+        const char* lineStart = skipBlanks(p, lineEnd);
+        p = lineEnd + 1;
+
+        if (lineEnd - lineStart < 2)
+            continue;
+
+        const char c0 = lineStart[0];
+        const char c1 = lineStart[1];
+
+        if (c0 == 'v')
+        {
+            const char* cursor = lineStart + 2;
+            const bool hasThirdChar = lineEnd - lineStart > 2;
+            vec3 in = { 0.f, 0.f, 0.f };
+            if (isBlank(c1))
+            {
+                // vertices after faces start a new block of faces
+                faceCount = 0;
+                if (parseFloat(cursor, lineEnd, in.x) && parseFloat(cursor, lineEnd, in.y) && parseFloat(cursor, lineEnd, in.z))
+                    vertices.push_back(in);
+            }
+            else if (c1 == 't' && hasThirdChar && isBlank(lineStart[2]))
+            {
+                ++cursor;
+                if (parseFloat(cursor, lineEnd, in.x) && parseFloat(cursor, lineEnd, in.y))
+                    texCoords.push_back(in.xy);
+            }
+            else if (c1 == 'n' && hasThirdChar && isBlank(lineStart[2]))
+            {
+                ++cursor;
+                if (parseFloat(cursor, lineEnd, in.x) && parseFloat(cursor, lineEnd, in.y) && parseFloat(cursor, lineEnd, in.z))
+                    normals.push_back(in);
+            }
+        }
+        else if (c0 == 'f' && isBlank(c1))
+        {
+            if ((!hasMTL && faceCount == 0) || data.meshes.empty())
+                data.meshes.push_back(ObjMesh());
+            ++faceCount;
+
+            const char* cursor = lineStart + 2;
+            size_t cornerCount = 0;
+            bool valid = true;
+            corners.clear();
+            while (valid)
+            {
+                cursor = skipBlanks(cursor, lineEnd);
+                if (cursor >= lineEnd)
+                    break;
+
+                corners.emplace_back();
+                FaceCorner& corner = corners[cornerCount++];
+                valid = parseCorner(cursor, lineEnd, corner);
+                if (!valid)
+                    break;
+
+                corner.position = resolveIndex(corner.position, vertices.size());
+                corner.texCoord = corner.texCoord == 0 ? -2 : resolveIndex(corner.texCoord, texCoords.size());
+                corner.normal = corner.normal == 0 ? -2 : resolveIndex(corner.normal, normals.size());
+                valid = corner.position >= 0 && corner.texCoord != -1 && corner.normal != -1;
+            }
+
+            if (!valid || cornerCount < 3)
+            {
+                ++skippedFaces;
+                continue;
+            }
+
+            ObjMesh& mesh = data.meshes.back();
+            mesh.faceType = cornerCount == 3 ? FaceType::TRIANGLE : FaceType::QUAD;
+
+            pushFan(mesh.indices, unsigned(mesh.rdrVertices.size()), cornerCount);
+
+            for (size_t i = 0; i < cornerCount; ++i)
+            {
+                const vec3& vertex = vertices[corners[i].position];
+                vec2 texCoord = corners[i].texCoord >= 0 ? texCoords[corners[i].texCoord] : vec2{ 0.f, 0.f };
+                vec3 normal = corners[i].normal >= 0 ? normals[corners[i].normal] : vec3{ 0.f, 0.f, 0.f };
+                const float* color = cornerColor(i);
+
+                mesh.rdrVertices.push_back(Core::rdrVertex{
+                    vertex.x, vertex.y, vertex.z,
+                    color[0], color[1], color[2], 1.f,
+                    normal.x, normal.y, normal.z,
+                    texCoord.x, texCoord.y,
+                    });
+            }
+        }
+        else if (c0 == 'u' || c0 == 'm')
+        {
+            std::string_view line = trimmed(lineStart, lineEnd);
+            if (startsWith(line, "mtllib"))
+            {
+                std::string_view file = trimmed(line.data() + 6, line.data() + line.size());
+                size_t slash = file.find_last_of("/\\");
+                if (slash != std::string_view::npos)
+                    file.remove_prefix(slash + 1);
+
+                hasMTL = true;
+                data.materialsFile = std::string(file);
+            }
+            else if (hasMTL && startsWith(line, "usemtl"))
+            {
+                ObjMesh mesh;
+                mesh.materialsInfo = std::string(trimmed(line.data() + 6, line.data() + line.size()));
+                data.meshes.push_back(mesh);
+            }
+        }
+    }
+
+    if (skippedFaces > 0)
+    {
+        std::string statement = "OBJ parser skipped " + std::to_string(skippedFaces)
+            + " faces (invalid indices or fewer than 3 vertices)";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+    }
+}
+
+void ObjParser::parseParallel(const char* text, size_t size, ObjData& data)
+{
+    Core::DataStructure::ThreadPool& pool = Core::DataStructure::ThreadPool::getInstance();
+
+    // a few chunks per thread so uneven lines balance out
+    size_t chunkCount = (pool.workerCount() + 1) * 4;
+    size_t chunkSize = size / chunkCount + 1;
+
+    std::vector<ObjChunk> chunks;
+    const char* begin = text;
+    const char* end = text + size;
+    while (begin < end)
+    {
+        const char* chunkEnd = begin + chunkSize < end ? begin + chunkSize : end;
+        const char* newline = static_cast<const char*>(std::memchr(chunkEnd - 1, '\n', size_t(end - (chunkEnd - 1))));
+        chunkEnd = newline ? newline + 1 : end;
+
+        ObjChunk chunk;
+        chunk.begin = begin;
+        chunk.end = chunkEnd;
+        chunks.push_back(std::move(chunk));
+        begin = chunkEnd;
+    }
+
+    pool.parallelFor(chunks.size(), [&chunks](size_t i) { tokenizeChunk(chunks[i]); });
+
+    // global list offsets of every chunk
+    size_t vertexCount = 0;
+    size_t texCoordCount = 0;
+    size_t normalCount = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        chunk.vertexOffset = vertexCount;
+        chunk.texCoordOffset = texCoordCount;
+        chunk.normalOffset = normalCount;
+        vertexCount += chunk.vertices.size();
+        texCoordCount += chunk.texCoords.size();
+        normalCount += chunk.normals.size();
+    }
+
+    std::vector<vec3> vertices(vertexCount);
+    std::vector<vec2> texCoords(texCoordCount);
+    std::vector<vec3> normals(normalCount);
+    pool.parallelFor(chunks.size(), [&](size_t i)
+    {
+        ObjChunk& chunk = chunks[i];
+        std::copy(chunk.vertices.begin(), chunk.vertices.end(), vertices.begin() + chunk.vertexOffset);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordOffset);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalOffset);
+        std::vector<vec3>().swap(chunk.vertices);
+        std::vector<vec2>().swap(chunk.texCoords);
+        std::vector<vec3>().swap(chunk.normals);
+    });
+
+    // replay the mesh boundaries in file order, exactly like the serial parser
+    bool hasMTL = false;
+    size_t faceCount = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        size_t event = 0;
+        size_t face = 0;
+        while (face < chunk.faces.size() || event < chunk.events.size())
+        {
+            for (; event < chunk.events.size() && chunk.events[event].faceIndex == face; ++event)
+            {
+                ObjEvent& record = chunk.events[event];
+                switch (record.type)
+                {
+                    case ObjEvent::Type::MTLLIB:
+                        hasMTL = true;
+                        data.materialsFile = record.name;
+                        break;
+                    case ObjEvent::Type::USEMTL:
+                        if (hasMTL)
+                        {
+                            ObjMesh mesh;
+                            mesh.materialsInfo = record.name;
+                            data.meshes.push_back(mesh);
+                        }
+                        break;
+                    case ObjEvent::Type::VERTICES:
+                        faceCount = 0;
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            if (face == chunk.faces.size())
+                break;
+
+            // faces up to the next event all go to the same mesh
+            size_t next = event < chunk.events.size() ? chunk.events[event].faceIndex : chunk.faces.size();
+
+            if ((!hasMTL && faceCount == 0) || data.meshes.empty())
+                data.meshes.push_back(ObjMesh());
+            faceCount += next - face;
+
+            ObjSegment segment;
+            segment.mesh = data.meshes.size() - 1;
+            segment.faceBegin = face;
+            segment.faceEnd = next;
+            chunk.segments.push_back(std::move(segment));
+
+            face = next;
+        }
+    }
+
+    pool.parallelFor(chunks.size(), [&](size_t i) { assembleChunk(chunks[i], vertices, texCoords, normals); });
+
+    int skippedFaces = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        skippedFaces += chunk.skippedFaces;
+        for (ObjSegment& segment : chunk.segments)
+        {
+            ObjMesh& mesh = data.meshes[segment.mesh];
+            if (segment.hasFaces)
+                mesh.faceType = segment.faceType;
+
+            if (mesh.rdrVertices.empty())
+            {
+                mesh.rdrVertices = std::move(segment.rdrVertices);
+                mesh.indices = std::move(segment.indices);
+            }
+            else
+            {
+                unsigned int offset = unsigned(mesh.rdrVertices.size());
+                mesh.rdrVertices.insert(mesh.rdrVertices.end(), segment.rdrVertices.begin(), segment.rdrVertices.end());
+                for (unsigned int index : segment.indices)
+                    mesh.indices.push_back(index + offset);
+            }
+        }
+    }
+
+    if (skippedFaces > 0)
+    {
+        std::string statement = "OBJ parser skipped " + std::to_string(skippedFaces)
+            + " faces (invalid indices or fewer than 3 vertices)";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+    }
+}
+
+void ObjParser::benchmark(const std::string& directory)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    if (!fs::is_directory(directory, error))
+    {
+        std::string statement = "OBJ benchmark: not a directory: " + directory;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return;
+    }
+
+    double totalMegabytes = 0.0;
+    double totalMilliseconds = 0.0;
+
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory, error))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".obj")
+            continue;
+
+        Core::IO::MappedFile file;
+        if (!file.open(entry.path().string()))
+            continue;
+
+        // best of a few runs, the first one also pays the page faults
+        double best = 0.0;
+        size_t vertexCount = 0;
+        for (int run = 0; run < 3; ++run)
+        {
+            ObjData data;
+            auto start = std::chrono::steady_clock::now();
+            parse(file.data(), file.size(), data);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (run == 0 || elapsed.count() < best)
+                best = elapsed.count();
+
+            vertexCount = 0;
+            for (const ObjMesh& mesh : data.meshes)
+                vertexCount += mesh.rdrVertices.size();
+        }
+
+        double megabytes = double(file.size()) / (1024.0 * 1024.0);
+        totalMegabytes += megabytes;
+        totalMilliseconds += best;
+
+        std::string statement = "OBJ benchmark: " + entry.path().filename().string() + " | "
+            + std::to_string(megabytes) + " MB | " + std::to_string(vertexCount) + " vertices | "
+            + std::to_string(best) + " ms | " + std::to_string(best > 0.0 ? megabytes / (best / 1000.0) : 0.0) + " MB/s";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+    }
+
+    std::string statement = "OBJ benchmark total: " + std::to_string(totalMegabytes) + " MB in "
+        + std::to_string(totalMilliseconds) + " ms | "
+        + std::to_string(totalMilliseconds > 0.0 ? totalMegabytes / (totalMilliseconds / 1000.0) : 0.0) + " MB/s";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+}
@@ -1,61 +1,183 @@
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <functional>
+#include <sstream>
 
 #include "resources/resourcesmanager.hpp"
+#include "resources/objparser.hpp"
+#include "resources/meshcache.hpp"
+#include "resources/textureregistry.hpp"
 #include "physics/transform.hpp"
+#include "core/datastructure/threadpool.hpp"
+#include "core/io/assetpack.hpp"
 #include "core/debug/log.hpp"
 #include "core/debug/assertion.hpp"
+#include "core/debug/loadprofiler.hpp"
 
 
 using namespace Resources;
 
-void ResourcesManager::addResource(const int resourceType, const std::vector<std::string>& modelShaders)
+bool ResourcesManager::hotReload = true;
+
+namespace
 {
-    auto& scene = scenes.back();
-    Core::Maths::vec3 lightCounts = { scene.dirLights.size(), scene.pointLights.size(), scene.spotLights.size() };
-    switch (latestTag)
+    struct JobTiming
     {
-        case static_cast<int>(Game::Tag::PLAYER):
-            scene.players.back().addShader(modelShaders, lightCounts);
-            break;
-        case static_cast<int>(Game::Tag::ENEMY):
-            scene.enemies.back().addShader(modelShaders, lightCounts);
-            break;
-        case static_cast<int>(Game::Tag::PLATFORM) :
-            scene.platforms.back().addShader(modelShaders, lightCounts);
-            break;
-        default:
-                    
-            break;
+        std::string stage;
+        std::string name;
+        double      milliseconds;
+    };
+
+    // one level of the load graph: the jobs only depend on the previous levels and run on the thread pool
+    void runStage(const std::string& stage, const std::vector<std::string>& names,
+        const std::function<void(size_t)>& job, std::vector<JobTiming>& timings)
+    {
+        if (names.empty())
+            return;
+
+        std::vector<double> durations(names.size());
+        auto start = std::chrono::steady_clock::now();
+
+        Core::DataStructure::ThreadPool::getInstance().parallelFor(names.size(), [&](size_t i)
+        {
+            auto jobStart = std::chrono::steady_clock::now();
+            job(i);
+            durations[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - jobStart).count();
+        });
+
+        double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        double busy = 0.0;
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            timings.push_back({ stage, names[i], durations[i] });
+            busy += durations[i];
+        }
+
+        std::string statement = "Load stage " + stage + ": " + std::to_string(names.size()) + " jobs | wall "
+            + std::to_string(wall) + " ms | busy " + std::to_string(busy) + " ms";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
     }
 
-    std::string statement = "Added shader";
-    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
-}
+    // jobs that need the GL context run on the calling thread
+    void runOnMainThread(const std::string& stage, const std::string& name, const std::function<void()>& job,
+        std::vector<JobTiming>& timings)
+    {
+        auto start = std::chrono::steady_clock::now();
+        job();
+        timings.push_back({ stage, name, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() });
+    }
 
-void ResourcesManager::addResource(const int resourceType, const std::string& resourceInfo, const bool collider)
-{  
-    switch (latestTag)
+    void dumpTimings(std::vector<JobTiming>& timings)
     {
-        case static_cast<int>(Game::Tag::PLAYER) :
-            if (collider)
-                scenes.back().players.back().addMesh();
-            else
-                scenes.back().players.back().addMesh(resourceInfo);
-            break;
-        case static_cast<int>(Game::Tag::ENEMY) :
-            if (collider)
-                scenes.back().enemies.back().addMesh();
-            else
-                scenes.back().enemies.back().addMesh(resourceInfo);
-            break;
-        case static_cast<int>(Game::Tag::PLATFORM) :
-            if (collider)
-                scenes.back().platforms.back().addMesh();
-            else
-                scenes.back().platforms.back().addMesh(resourceInfo);
-            break;
-        default:
-            break;
+        std::sort(timings.begin(), timings.end(), [](const JobTiming& a, const JobTiming& b)
+        {
+            return a.milliseconds > b.milliseconds;
+        });
+
+        for (const JobTiming& timing : timings)
+        {
+            std::string statement = "Load job " + timing.stage + " | " + timing.name + " | "
+                + std::to_string(timing.milliseconds) + " ms";
+            Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
+        }
+    }
+
+    size_t gameObjectCount(const Scene& scene, int tag)
+    {
+        switch (tag)
+        {
+            case static_cast<int>(Game::Tag::PLAYER) :
+                return scene.players.size();
+            case static_cast<int>(Game::Tag::ENEMY) :
+                return scene.enemies.size();
+            case static_cast<int>(Game::Tag::PLATFORM) :
+                return scene.platforms.size();
+            default:
+                return 0;
+        }
+    }
+
+    Game::GameObject* gameObjectAt(Scene& scene, int tag, size_t index)
+    {
+        switch (tag)
+        {
+            case static_cast<int>(Game::Tag::PLAYER) :
+                return &scene.players[index];
+            case static_cast<int>(Game::Tag::ENEMY) :
+                return &scene.enemies[index];
+            case static_cast<int>(Game::Tag::PLATFORM) :
+                return &scene.platforms[index];
+            default:
+                return nullptr;
+        }
+    }
+
+    // the objects streamed in by a world are only listed by the gameObjects of the scene
+    void collectGameObjects(std::vector<Scene>& scenes, std::vector<Game::GameObject*>& gameObjects)
+    {
+        for (Scene& scene : scenes)
+        {
+            for (Game::Player& player : scene.players)
+                gameObjects.push_back(&player);
+            for (Game::Enemy& enemy : scene.enemies)
+                gameObjects.push_back(&enemy);
+            for (Game::Platform& platform : scene.platforms)
+                gameObjects.push_back(&platform);
+            gameObjects.insert(gameObjects.end(), scene.gameObjects.begin(), scene.gameObjects.end());
+        }
+    }
+
+    std::string setupKey(const ModelInfo& model)
+    {
+        std::string key = model.name + '|' + std::to_string(int(model.attribs.back())) + '|' + model.colliderName + '|' + model.customTexture;
+        for (const std::string& shader : model.shaders)
+            key += '|' + shader;
+        return key;
+    }
+
+    std::string shaderKey(const std::vector<std::string>& shaders, const Core::Maths::vec3& lightCounts)
+    {
+        std::string key;
+        for (const std::string& shader : shaders)
+            key += shader + '|';
+        return key + std::to_string(int(lightCounts.x)) + '|' + std::to_string(int(lightCounts.y)) + '|'
+            + std::to_string(int(lightCounts.z));
+    }
+
+    struct ObjResult
+    {
+        std::vector<Mesh>   meshes;
+        std::string         materialsFile;
+        bool                loaded = false;
+    };
+
+    // the file name of a map statement: options (-s, -o, -bm...) come first, folders are dropped
+    std::string mapFile(std::istringstream& arguments)
+    {
+        std::string rest;
+        std::getline(arguments >> std::ws, rest);
+        while (!rest.empty() && (rest.back() == '\r' || rest.back() == ' ' || rest.back() == '\t'))
+            rest.pop_back();
+
+        if (!rest.empty() && rest[0] == '-')
+        {
+            size_t separator = rest.find_last_of(" \t");
+            rest = separator == std::string::npos ? "" : rest.substr(separator + 1);
+        }
+
+        size_t folder = rest.find_last_of('\\');
+        return folder == std::string::npos ? rest : rest.substr(folder + 1);
+    }
+
+    // a single value is a grey
+    Core::Maths::vec3 readColor(std::istringstream& arguments)
+    {
+        Core::Maths::vec3 color = { 0.f, 0.f, 0.f };
+        arguments >> color.x;
+        if (!(arguments >> color.y >> color.z))
+            color.y = color.z = color.x;
+        return color;
     }
 }
 
@@ -102,502 +224,489 @@ void ResourcesManager::addResource(const int resourceType, const int value)
 	}
 }
 
-void ResourcesManager::loadObj(
-        std::string& modelName, const std::vector<float>& modelObjAttribs, const std::string& colliderName, 
-        const std::vector<float>& colliderAttribs, const std::vector<std::string>& modelShaders, const std::vector<int>& gameObjAttribs,
-        const std::string& customTexture
-)
+void ResourcesManager::loadModels(Scene& scene, const std::vector<ModelInfo>& models)
 {
-    for (size_t i = modelName.length() - 1; i > 0; --i)
+    auto start = std::chrono::steady_clock::now();
+    std::vector<JobTiming> timings;
+
+    // every game object is created before any pointer to it is taken: the scene vectors must not grow afterwards
+    std::vector<size_t> indices;
+    for (const ModelInfo& info : models)
     {
-        if (modelName[i] == '_')
-            modelName.pop_back();
+        int tag = int(info.attribs.back());
+        scene.addGameObject(info.attribs, info.colliderName, info.colliderAttribs, info.gameObjectAttribs, info.customTexture);
+        indices.push_back(gameObjectCount(scene, tag) - 1);
+    }
+
+    std::vector<Game::GameObject*> gameObjects;
+    for (size_t i = 0; i < models.size(); ++i)
+        gameObjects.push_back(gameObjectAt(scene, int(models[i].attribs.back()), indices[i]));
+
+    // the instances of a prefab, or any models with the same files, are set up once: the others copy
+    // the meshes, materials, textures and programs of the first one
+    std::vector<size_t> sources(models.size());
+    std::map<std::string, size_t> firstInstances;
+    for (size_t i = 0; i < models.size(); ++i)
+        sources[i] = firstInstances.emplace(setupKey(models[i]), i).first->second;
+
+    // OBJ files (or their baked cache), once per model name
+    Core::Debug::LoadProfiler& profiler = Core::Debug::LoadProfiler::getInstance();
+    std::vector<std::string> objNames;
+    std::vector<size_t> objModels;
+    for (size_t i = 0; i < models.size(); ++i)
+    {
+        const std::string& name = models[i].name;
+        if (!gameObjects[i] || sources[i] != i)
+            continue;
+
+        if (cachedModelMeshes.count(name) == 0 && std::find(objNames.begin(), objNames.end(), name) == objNames.end())
+        {
+            objNames.push_back(name);
+            objModels.push_back(i);
+            profiler.cacheMiss("model meshes");
+        }
         else
-            break;
+        {
+            profiler.cacheHit("model meshes");
+        }
     }
 
-    std::string filepath = "Assets/models/" + modelName + ".obj";
-    const char* modelPath = filepath.c_str();
-    std::string filepath2 = "Assets/colliders/" + colliderName + ".obj";
-    const char* colliderPath = filepath2.c_str();
+    std::vector<ObjResult> objResults(objNames.size());
+    runStage("OBJ", objNames, [&](size_t i)
+    {
+        const ModelInfo& info = models[objModels[i]];
+        objResults[i].loaded = loadObj(info.name, info.colliderName, gameObjects[objModels[i]]->transform,
+            objResults[i].meshes, objResults[i].materialsFile);
+    }, timings);
+
+    for (size_t i = 0; i < objNames.size(); ++i)
+    {
+        if (!objResults[i].loaded)
+        {
+            std::string statement = "Unable to load model: " + objNames[i];
+            Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
+            continue;
+        }
 
-    scenes.back().addGameObject(modelObjAttribs, colliderName, colliderAttribs, gameObjAttribs, customTexture);
-    latestTag = int(modelObjAttribs.back());
+        if (!objResults[i].materialsFile.empty())
+            cachedMTLFiles.emplace(objNames[i], objResults[i].materialsFile);
+        cachedModelMeshes.emplace(objNames[i], std::move(objResults[i].meshes));
 
-    addResource(static_cast<int>(Resources::ResourceType::SHADER), modelShaders);
-    if (loadObj(modelPath, colliderPath, modelName))
+        const std::string& colliderName = models[objModels[i]].colliderName;
+        cachedColliderNames.emplace(objNames[i], colliderName);
+        track("Assets/models/" + objNames[i] + ".obj", ResourceType::MESH, objNames[i]);
+        track("Assets/colliders/" + colliderName + ".obj", ResourceType::MESH, objNames[i]);
+    }
+
+    // MTL files, once per file: the registry keeps them for the next objects and scenes
+    MaterialRegistry& materialRegistry = MaterialRegistry::getInstance();
+    std::vector<std::string> mtlNames;
+    for (size_t i = 0; i < models.size(); ++i)
     {
-        switch (latestTag)
+        if (!gameObjects[i] || sources[i] != i)
+            continue;
+
+        gameObjects[i]->model.name = models[i].name;
+        gameObjects[i]->model.materialsFile = cachedMTLFiles[models[i].name];
+        gameObjects[i]->fillMesh(cachedModelMeshes[models[i].name]);
+
+        const std::string& materialsFile = gameObjects[i]->model.materialsFile;
+        Core::Debug::Assertion::assertTest(!materialsFile.empty());
+        if (!materialRegistry.contains(materialsFile)
+            && std::find(mtlNames.begin(), mtlNames.end(), materialsFile) == mtlNames.end())
         {
-            case static_cast<int>(Game::Tag::PLAYER) :
-                for (Resources::Mesh& mesh : scenes.back().players.back().model.meshes)
-                {
-                    mesh.setIndices();
-                }
-                break;
-            case static_cast<int>(Game::Tag::ENEMY) :
-                for (Resources::Mesh& mesh : scenes.back().enemies.back().model.meshes)
-                {
-                    mesh.setIndices();
-                }
-                break;
-            case static_cast<int>(Game::Tag::PLATFORM) :
-                for (Resources::Mesh& mesh : scenes.back().platforms.back().model.meshes)
-                {
-                    mesh.setIndices();
-                }
-            default:
-                break;
+            mtlNames.push_back(materialsFile);
+            profiler.cacheMiss("materials");
+        }
+        else
+        {
+            profiler.cacheHit("materials");
         }
-        
     }
-    loadMaterials();
-    
-}
 
-bool ResourcesManager::loadObj(const char* modelFile, const char* colliderFile, const std::string& modelName)
-{
-    using namespace Core::Maths;
+    std::vector<std::vector<Material>> mtlResults(mtlNames.size());
+    std::vector<char> mtlLoaded(mtlNames.size(), 0);
+    runStage("MTL", mtlNames, [&](size_t i)
+    {
+        mtlLoaded[i] = parseMtl(mtlNames[i], mtlResults[i]);
+    }, timings);
 
-    if (cachedModelMeshes.count(modelName) > 0 && cachedModelType.count(modelName) > 0)
+    for (size_t i = 0; i < mtlNames.size(); ++i)
     {
-        loadCachedGO(modelName);
-        return true;
+        if (!mtlLoaded[i])
+        {
+            std::string statement = "Unable to open file: Assets/mtls/" + mtlNames[i];
+            Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
+        }
+        materialRegistry.add(mtlNames[i], std::move(mtlResults[i]));
+        track("Assets/mtls/" + mtlNames[i], ResourceType::MATERIAL, mtlNames[i]);
     }
-    else
-    {
-        // ASSERT
-        Core::Debug::Assertion::assertTest(!std::string(modelFile).empty());
-        Core::Debug::Assertion::assertTest(!std::string(colliderFile).empty());
+    materialRegistry.upload();
 
-        std::vector<const char*> files = { modelFile, colliderFile };
+    // textures, shared through the registry which only requests the files it does not hold yet
+    for (size_t i = 0; i < models.size(); ++i)
+    {
+        if (gameObjects[i] && sources[i] == i)
+            applyMaterials(*gameObjects[i]);
+    }
 
-        std::vector<Mesh>		meshes;
+    Core::Maths::vec3 lightCounts = { float(scene.dirLights.size()), float(scene.pointLights.size()), float(scene.spotLights.size()) };
+    for (size_t i = 0; i < models.size(); ++i)
+    {
+        if (!gameObjects[i] || sources[i] != i)
+            continue;
 
-        int meshesStart = int(meshes.size());
-        int meshesEnd = meshesStart;
+        // programs are shared by the objects built from the same files and light counts
+        std::string key = shaderKey(models[i].shaders, lightCounts);
+        auto cached = cachedShaders.find(key);
+        if (cached != cachedShaders.end())
+        {
+            profiler.cacheHit("shaders");
+            gameObjects[i]->model.gfxShader = cached->second.first;
+            gameObjects[i]->model.colliderShader = cached->second.second;
+            continue;
+        }
+        profiler.cacheMiss("shaders");
 
-        for (const char* file : files)
+        runOnMainThread("Shader", models[i].name, [&]()
         {
-            std::ifstream readFile;
-            readFile.open(file, std::ios::in);
+            gameObjects[i]->addShader(models[i].shaders, lightCounts);
+        }, timings);
+        cachedShaders.emplace(key, std::make_pair(gameObjects[i]->model.gfxShader, gameObjects[i]->model.colliderShader));
+        for (const std::string& shader : models[i].shaders)
+            track("Bin/shaders/" + shader, ResourceType::SHADER, shader);
+    }
 
+    for (size_t i = 0; i < models.size(); ++i)
+    {
+        if (gameObjects[i] && sources[i] != i && gameObjects[sources[i]])
+            gameObjects[i]->model = gameObjects[sources[i]]->model;
+    }
 
-            if (readFile.is_open())
-            {
-                std::string line;
-
-                std::vector<vec3> vertices;
-                std::vector<vec2> texCoords;
-                std::vector<vec3> normals;
-                bool addedTexture = false;
-                bool hasMTL = false;
-                int faceCount = 0;
-
-                while (std::getline(readFile, line))
-                {
-                    if (line[0] != 'v' && line[0] != 'f' && line[0] != 'u' && line[0] != 'm')
-                        continue;
-
-                    std::string category;
-                    std::string text;
-                    bool categoryFound = false;
-                    bool faceCountIncremented = false;
-                    bool addedVertexCount = false;
-                    vec3 in;
-                    int count = 0;
-                    int specs[12];
-
-                    for (int i = 0; i < line.length(); ++i)
-                    {
-                        int endOfLine = i + 1;
-                        char c = line[i];
-                        if (!categoryFound)
-                        {
-                            if (c == ' ')
-                            {
-                                categoryFound = true;
-                            }
-                            else
-                            {
-                                category += c;
-                                continue;
-                            }
-                        }
-                        else
-                        {
-                            if (faceCount > 0 && category == "v")
-                            {
-                                addResource(static_cast<int>(Resources::ResourceType::TEXTURE), faceCount * 3);
-                                faceCount = 0;
-                            }
-
-                            if (category == "v" && addedTexture)
-                            {
-                                addedTexture = false;
-                            }
-
-                            if (category == "mtllib" && c != '/')
-                            {
-                                text += c;
-                            }
-                            else if (c != ' ' && c != '/')
-                            {
-                                text += c;
-                            }
-
-                            if (category == "v" || category == "vt" || category == "vn")
-                            {
-
-
-                                if ((i + 1) == (int)line.length() || line[endOfLine] == ' ')
-                                {
-                                    count++;
-                                    if (count == 1)
-                                        in.x = std::stof(text);
-                                    else if (count == 2)
-                                        in.y = std::stof(text);
-                                    else if (count == 3)
-                                        in.z = std::stof(text);
-                                    text = "";
-                                }
-
-                                if (category == "v" && count == 3)
-                                {
-                                    vertices.push_back(in);
-                                    in = { 0.f, 0.f, 0.f };
-                                    count = 0;
-                                }
-                                else if (category == "vt" && count == 2)
-                                {
-                                    texCoords.push_back(in.xy);
-                                    in = { 0.f, 0.f, 0.f };
-                                    count = 0;
-                                }
-                                else if (category == "vn" && count == 3)
-                                {
-                                    normals.push_back(in);
-                                    in = { 0.f, 0.f, 0.f };
-                                    count = 0;
-                                }
-                                continue;
-                            }
-                            else if (category == "f")
-                            {
-                                if (!hasMTL && faceCount == 0)
-                                {
-                                    std::string temp = "";
-                                    addResource(static_cast<int>(Resources::ResourceType::MESH), temp, true);
-                                    cachedMTLNames.emplace(modelName, text);
-                                    cachedModelType.emplace(modelName, true);
-                                    switch (latestTag)
-                                    {
-                                        case static_cast<int>(Game::Tag::PLAYER) :
-                                            meshes.push_back(scenes.back().players.back().model.meshes.back());
-                                            break;
-                                        case static_cast<int>(Game::Tag::ENEMY) :
-                                            meshes.push_back(scenes.back().enemies.back().model.meshes.back());
-                                            break;
-                                        case static_cast<int>(Game::Tag::PLATFORM) :
-                                            meshes.push_back(scenes.back().platforms.back().model.meshes.back());
-                                            break;
-                                        default:
-                                            break;
-                                    }
-                                    ++meshesEnd;
-                                }
-
-                                if (!faceCountIncremented)
-                                {
-                                    ++faceCount;
-                                    faceCountIncremented = true;
-                                }
-
-                                if (((i + 1) == (int)line.length() && text != "") || line[endOfLine] == ' ' || line[endOfLine] == '/')
-                                {
-                                    specs[count] = std::stoi(text) - 1;
-                                    count++;
-                                    text = "";
-                                }
-                                if (count == 9 && (i + 1) == (int)line.length()) // triangle face
-                                {
-                                    if (meshes.back().faceType != FaceType::TRIANGLE)
-                                        meshes.back().faceType = FaceType::TRIANGLE;
-                                    vec3 vertex[3] = { vertices.at(specs[0]), vertices.at(specs[3]), vertices.at(specs[6]) };
-                                    vec2 texCoord[3] = { texCoords.at(specs[1]), texCoords.at(specs[4]), texCoords.at(specs[7]) };
-                                    vec3 normal[3] = { normals.at(specs[2]), normals.at(specs[5]), normals.at(specs[8]) };
-                                    meshes.back().rdrVertices.push_back(Core::rdrVertex{
-                                        vertex[0].x, vertex[0].y, vertex[0].z,
-                                        1.f, 0.f, 0.f, 1.f,
-                                        normal[0].x, normal[0].y, normal[0].z,
-                                        texCoord[0].x, texCoord[0].y,
-                                        });
-                                    meshes.back().rdrVertices.push_back(Core::rdrVertex{
-                                        vertex[1].x, vertex[1].y, vertex[1].z,
-                                        0.f, 1.f, 0.f, 1.f,
-                                        normal[1].x, normal[1].y, normal[1].z,
-                                        texCoord[1].x, texCoord[1].y,
-                                        });
-                                    meshes.back().rdrVertices.push_back(Core::rdrVertex{
-                                        vertex[2].x, vertex[2].y, vertex[2].z,
-                                        0.f, 0.f, 1.f, 1.f,
-                                        normal[2].x, normal[2].y, normal[2].z,
-                                        texCoord[2].x, texCoord[2].y,
-                                        });
-                                    count = 0;
-                                }
-                                else if (count == 12) // 4-vertex face
-                                {
-                                    if (meshes.back().faceType != FaceType::QUAD)
-                                        meshes.back().faceType = FaceType::QUAD;
-                                    vec3 vertex[4] = { vertices.at(specs[0]), vertices.at(specs[3]), vertices.at(specs[6]), vertices.at(specs[9]) };
-                                    vec2 texCoord[4] = { texCoords.at(specs[1]), texCoords.at(specs[4]), texCoords.at(specs[7]), texCoords.at(specs[10]) };
-                                    vec3 normal[4] = { normals.at(specs[2]), normals.at(specs[5]), normals.at(specs[8]), normals.at(specs[11]) };
-                                    meshes.back().rdrVertices.push_back(Core::rdrVertex{
-                                        vertex[0].x, vertex[0].y, vertex[0].z,
-                                        1.f, 0.f, 0.f, 1.f,
-                                        normal[0].x, normal[0].y, normal[0].z,
-                                        texCoord[0].x, texCoord[0].y,
-                                        });
-                                    meshes.back().rdrVertices.push_back(Core::rdrVertex{
-                                        vertex[1].x, vertex[1].y, vertex[1].z,
-                                        0.f, 1.f, 0.f, 1.f,
-                                        normal[1].x, normal[1].y, normal[1].z,
-                                        texCoord[1].x, texCoord[1].y,
-                                        });
-                                    meshes.back().rdrVertices.push_back(Core::rdrVertex{
-                                        vertex[2].x, vertex[2].y, vertex[2].z,
-                                        0.f, 0.f, 1.f, 1.f,
-                                        normal[2].x, normal[2].y, normal[2].z,
-                                        texCoord[2].x, texCoord[2].y,
-                                        });
-                                    meshes.back().rdrVertices.push_back(Core::rdrVertex{
-                                        vertex[3].x, vertex[3].y, vertex[3].z,
-                                        0.f, 0.f, 1.f, 1.f,
-                                        normal[3].x, normal[3].y, normal[3].z,
-                                        texCoord[3].x, texCoord[3].y,
-                                        });
-
-                                    count = 0;
-                                }
-                            }
-                            else if ((i + 1) == (int)line.length())
-                            {
-                                if (category == "mtllib")
-                                {
-                                    hasMTL = true;
-                                    cachedMTLFiles.emplace(modelName, text);
-
-                                }
-                                else if (hasMTL && category == "usemtl")
-                                {
-                                    addResource(static_cast<int>(Resources::ResourceType::MESH), text, false);
-                                    cachedMTLNames.emplace(modelName, text);
-                                    cachedModelType.emplace(modelName, false);
-                                    switch (latestTag)
-                                    {
-                                        case static_cast<int>(Game::Tag::PLAYER) :
-                                            meshes.push_back(scenes.back().players.back().model.meshes.back());
-                                            break;
-                                        case static_cast<int>(Game::Tag::ENEMY) :
-                                            meshes.push_back(scenes.back().enemies.back().model.meshes.back());
-                                            break;
-                                        case static_cast<int>(Game::Tag::PLATFORM) :
-                                            meshes.push_back(scenes.back().platforms.back().model.meshes.back());
-                                            break;
-                                        default:
-
-                                            break;
-                                    }
-                                    ++meshesEnd;
-                                }
-                            }
-                        }
-                    }
-                }
-                readFile.close();
-                if (faceCount > 0)
-                {
-                    addResource(static_cast<int>(Resources::ResourceType::TEXTURE), faceCount * 3);
-                    faceCount = 0;
-                }
-            }
-            else
+    dumpTimings(timings);
+
+    std::string statement = "Loaded " + std::to_string(models.size()) + " models (" + std::to_string(firstInstances.size())
+        + " set up) of scene " + scene.name + " in "
+        + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+}
+
+void ResourcesManager::reloadChanged(std::vector<Scene>& liveScenes)
+{
+    if (!hotReload)
+        return;
+
+    std::vector<std::string> changed = watcher.poll();
+    if (changed.empty())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Game::GameObject*> gameObjects;
+    collectGameObjects(scenes, gameObjects);
+    collectGameObjects(liveScenes, gameObjects);
+    std::sort(gameObjects.begin(), gameObjects.end());
+    gameObjects.erase(std::unique(gameObjects.begin(), gameObjects.end()), gameObjects.end());
+
+    for (const std::string& path : changed)
+    {
+        std::string statement = "Hot reload: " + path;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+
+        // the packed copy is older than the edited file
+        Core::IO::AssetPack::getInstance().invalidate(path);
+
+        // copied, reloading may watch new files
+        std::set<std::pair<ResourceType, std::string>> resources = dependencies[path];
+        for (const auto& resource : resources)
+        {
+            switch (resource.first)
             {
-                std::string statement = "Unable to open file: " + std::string(file);
-                Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
-                return false;
+                case ResourceType::MESH:
+                    reloadMesh(resource.second, gameObjects);
+                    break;
+                case ResourceType::MATERIAL:
+                    reloadMaterials(resource.second, gameObjects);
+                    break;
+                case ResourceType::TEXTURE:
+                    TextureRegistry::getInstance().reload(resource.second);
+                    break;
+                case ResourceType::SHADER:
+                    reloadShader(resource.second, gameObjects);
+                    break;
+                default:
+                    break;
             }
         }
+    }
 
-        cachedModelMeshes.emplace(modelName, std::vector<Resources::Mesh>(meshes.begin() + meshesStart, meshes.begin() + meshesEnd));
+    std::string statement = "Hot reload: " + std::to_string(changed.size()) + " files in "
+        + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+}
 
+void ResourcesManager::applyMaterials(Game::GameObject& gameObject)
+{
+    std::vector<TextureHandle> textures;
 
-        loadCachedGO(modelName);
+    const MaterialLibrary& library = MaterialRegistry::getInstance().find(gameObject.model.materialsFile);
+    for (const std::string& texture : gameObject.textureFiles(library))
+    {
+        if (texture.empty())
+        {
+            textures.push_back(TextureHandle());
+            continue;
+        }
 
-        return true;
+        textures.push_back(TextureRegistry::getInstance().acquire(texture));
+        track("Assets/textures/" + texture, ResourceType::TEXTURE, texture);
     }
-    return false;
+
+    gameObject.setMaterials(library);
+    gameObject.setTextures(textures);
 }
 
-void Resources::ResourcesManager::loadCachedGO(const std::string& modelName)
+void ResourcesManager::track(const std::string& path, ResourceType type, const std::string& name)
 {
-    switch (latestTag)
+    dependencies[path].emplace(type, name);
+    watcher.watch(path);
+}
+
+void ResourcesManager::reloadMesh(const std::string& modelName, const std::vector<Game::GameObject*>& gameObjects)
+{
+    // the meshes take the transform of the first object, as when the scene was loaded
+    Physics::Transform transform;
+    for (Game::GameObject* gameObject : gameObjects)
     {
-        case static_cast<int>(Game::Tag::PLAYER) :
-            scenes.back().players.back().model.materialsFile = cachedMTLFiles[modelName];
-            addResource(static_cast<int>(Resources::ResourceType::MESH), cachedMTLNames[modelName], cachedModelType[modelName]);
-            scenes.back().players.back().fillMesh(cachedModelMeshes[modelName]);
-            break;
-        case static_cast<int>(Game::Tag::ENEMY) :
-            scenes.back().enemies.back().model.materialsFile = cachedMTLFiles[modelName];
-            addResource(static_cast<int>(Resources::ResourceType::MESH), cachedMTLNames[modelName], cachedModelType[modelName]);
-            scenes.back().enemies.back().fillMesh(cachedModelMeshes[modelName]);
-            break;
-        case static_cast<int>(Game::Tag::PLATFORM) :
-            scenes.back().platforms.back().model.materialsFile = cachedMTLFiles[modelName];
-            addResource(static_cast<int>(Resources::ResourceType::MESH), cachedMTLNames[modelName], cachedModelType[modelName]);
-            scenes.back().platforms.back().fillMesh(cachedModelMeshes[modelName]);
-            break;
-        default:
+        if (gameObject->model.name == modelName)
+        {
+            transform = gameObject->transform;
             break;
+        }
+    }
+
+    std::vector<Mesh> meshes;
+    std::string materialsFile;
+    if (!loadObj(modelName, cachedColliderNames[modelName], transform, meshes, materialsFile))
+    {
+        std::string statement = "Hot reload: unable to load model " + modelName + ", previous meshes kept";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return;
     }
-}
 
+    cachedModelMeshes[modelName] = std::move(meshes);
+    if (!materialsFile.empty())
+        cachedMTLFiles[modelName] = materialsFile;
 
-void ResourcesManager::loadMaterials()
-{
-    std::vector<std::string> materials;
-    std::vector<std::string> texFiles;
- 
-    parseMtl(materials, texFiles);
-    loadTextures(materials, texFiles);
-}
+    const std::string& modelMaterials = cachedMTLFiles[modelName];
+    if (!modelMaterials.empty() && !MaterialRegistry::getInstance().contains(modelMaterials))
+        reloadMaterials(modelMaterials, {});
 
+    for (Game::GameObject* gameObject : gameObjects)
+    {
+        if (gameObject->model.name != modelName)
+            continue;
 
-void ResourcesManager::parseMtl(std::vector<std::string>& materials, std::vector<std::string>& texFiles)
+        gameObject->model.materialsFile = modelMaterials;
+        gameObject->fillMesh(cachedModelMeshes[modelName]);
+        applyMaterials(*gameObject);
+        gameObject->defineVAO();
+    }
+}
+
+void ResourcesManager::reloadMaterials(const std::string& materialsFile, const std::vector<Game::GameObject*>& gameObjects)
 {
+    std::vector<Material> materials;
+    if (!parseMtl(materialsFile, materials))
+    {
+        std::string statement = "Hot reload: unable to open file Assets/mtls/" + materialsFile + ", previous materials kept";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return;
+    }
 
-    std::string path = "";
-    
-    switch (latestTag)
+    // same slots: the meshes see the new values as soon as the buffer is uploaded
+    MaterialRegistry::getInstance().add(materialsFile, std::move(materials));
+    MaterialRegistry::getInstance().upload();
+    track("Assets/mtls/" + materialsFile, ResourceType::MATERIAL, materialsFile);
+
+    for (Game::GameObject* gameObject : gameObjects)
     {
-        case static_cast<int>(Game::Tag::PLAYER) :
-            Core::Debug::Assertion::assertTest(!scenes.back().players.back().model.materialsFile.empty());
-            path = "Assets/mtls/" + scenes.back().players.back().model.materialsFile;
-            break;
-        case static_cast<int>(Game::Tag::ENEMY) :
-            Core::Debug::Assertion::assertTest(!scenes.back().enemies.back().model.materialsFile.empty());
-            path = "Assets/mtls/" + scenes.back().enemies.back().model.materialsFile;
-            break;
-        case static_cast<int>(Game::Tag::PLATFORM) :
-            Core::Debug::Assertion::assertTest(!scenes.back().platforms.back().model.materialsFile.empty());
-            path = "Assets/mtls/" + scenes.back().platforms.back().model.materialsFile;
-            break;
-        default:
-            break;
+        if (gameObject->model.materialsFile == materialsFile)
+            applyMaterials(*gameObject);
     }
-    
-    const char* filename = path.c_str();
+}
 
-    std::string statement = "Materials file: " + path;
+void ResourcesManager::reloadShader(const std::string& shaderFile, const std::vector<Game::GameObject*>& gameObjects)
+{
+    // objects built from the same files and light counts share the new program
+    std::map<std::string, GLuint> programs;
+    std::set<GLuint> previousPrograms;
+    size_t patched = 0;
+
+    // the cached programs are handed to the objects loaded from now on
+    std::vector<Shader*> shaders;
+    for (Game::GameObject* gameObject : gameObjects)
+        shaders.insert(shaders.end(), { &gameObject->model.gfxShader, &gameObject->model.colliderShader });
+    for (auto& cached : cachedShaders)
+        shaders.insert(shaders.end(), { &cached.second.first, &cached.second.second });
+
+    for (Shader* shader : shaders)
+    {
+        if (shader->vertexFile != shaderFile && shader->fragFile != shaderFile)
+            continue;
+
+        const Core::Maths::vec3& lights = shader->lightCounts;
+        std::string key = shader->vertexFile + '|' + shader->fragFile + '|' + std::to_string(int(lights.x)) + '|'
+            + std::to_string(int(lights.y)) + '|' + std::to_string(int(lights.z));
+
+        auto program = programs.find(key);
+        if (program == programs.end())
+        {
+            // a failed compilation keeps the current program of every object with these files
+            Shader reloaded = *shader;
+            program = programs.emplace(key, reloaded.reload() ? reloaded.shaderProgram : 0).first;
+        }
+
+        if (program->second == 0)
+            continue;
+
+        previousPrograms.insert(shader->shaderProgram);
+        shader->shaderProgram = program->second;
+        ++patched;
+    }
+
+    for (GLuint program : previousPrograms)
+        glDeleteProgram(program);
+
+    std::string statement = "Shader reloaded: " + shaderFile + " | " + std::to_string(programs.size()) + " programs for "
+        + std::to_string(patched) + " shaders";
     Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
-    
+}
+
+bool ResourcesManager::loadObj(const std::string& modelName, const std::string& colliderName,
+    const Physics::Transform& transform, std::vector<Mesh>& meshes, std::string& materialsFile) const
+{
+    // ASSERT
+    Core::Debug::Assertion::assertTest(!modelName.empty());
+    Core::Debug::Assertion::assertTest(!colliderName.empty());
+
+    std::vector<std::string> files = { "Assets/models/" + modelName + ".obj", "Assets/colliders/" + colliderName + ".obj" };
+    std::string cacheFile = MeshCache::cachePath(modelName, colliderName);
 
-    std::ifstream readFile;
-    readFile.open(filename, std::ios::in);
-    if (readFile.is_open())
+    Core::Debug::LoadProfiler& profiler = Core::Debug::LoadProfiler::getInstance();
+    if (MeshCache::load(cacheFile, files, transform, materialsFile, meshes))
     {
-        std::string line;
+        profiler.cacheHit("mesh cache files");
+        return true;
+    }
+    profiler.cacheMiss("mesh cache files");
+
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const std::string& file = files[i];
+        bool collider = i == 1;
 
-        while (std::getline(readFile, line))
+        ObjData data;
+        if (!ObjParser::parseFile(file, data))
         {
-            if (line[0] != 'n' && line[0] != 'm')
-                continue;
+            std::string statement = "Unable to open file: " + file;
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+            return false;
+        }
 
-            std::string category;
-            std::string text;
-            bool categoryFound = false;
-            bool atIndex0 = true;
-            int count = 0;
+        if (!data.materialsFile.empty() && materialsFile.empty())
+            materialsFile = data.materialsFile;
 
-            for (int i = 0; i < line.length(); ++i)
-            {
-                char c = line[i];
-                if (!categoryFound)
-                {
-                    if (c == ' ')
-                    {
-                        categoryFound = true;
-                    }
-                    else
-                    {
-                        category += c;
-                        continue;
-                    }
-                }
-                else
-                {
-                    if (c != ' ' && atIndex0)
-                    {
-                        text += c;
-                        atIndex0 = false;
-                    }
-                    else
-                    {
-                        text += c;
-                    }
-
-                    if ((i + 1) == (int)line.length())
-                    {
-                        if (category == "newmtl")
-                        {
-                            materials.push_back(text);
-                        }
-                        else if (category == "map_Kd")
-                        {
-                            for (int i = 0; i < text.length(); ++i)
-                            {
-                                if (text[i] == '\\')
-                                {
-                                    int iplus1 = i + 1;
-                                    text = text.substr(iplus1, text.length() - (iplus1));
-                                    i = 0;
-                                }
-                            }
-                            texFiles.push_back(text);
-                        }
-                    }
-                }
-            }
+        // the LODs index the reordered vertices, colliders are always drawn in full
+        ObjParser::optimize(file, data);
+        if (!collider)
+            ObjParser::buildLods(file, data);
+
+        for (ObjMesh& objMesh : data.meshes)
+        {
+            meshes.push_back(Mesh(objMesh.materialsInfo, transform));
+            meshes.back().faceType = objMesh.faceType;
+            meshes.back().setGeometry(std::move(objMesh.rdrVertices), std::move(objMesh.indices), std::move(objMesh.lods));
         }
-        readFile.close();
     }
-    else
+
+    if (MeshCache::save(cacheFile, files, materialsFile, meshes))
     {
-        std::string statement = "Unable to open file: " + std::string(filename);
-        Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
+        std::string statement = "Baked mesh cache: " + cacheFile;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
     }
+
+    return true;
 }
 
 
-void	ResourcesManager::loadTextures(const std::vector<std::string>& materials, const std::vector<std::string>& texFiles)
+bool ResourcesManager::parseMtl(const std::string& materialsFile, std::vector<Material>& materials) const
 {
-    switch (latestTag)
+    std::string path = "Assets/mtls/" + materialsFile;
+
+    std::string statement = "Materials file: " + path;
+    Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
+
+    Core::IO::AssetFile readFile;
+    if (!readFile.open(path))
+        return false;
+
+    Core::Debug::LoadProfiler::Scope profile(Core::Debug::LoadStage::MTL_PARSE, path);
+    profile.bytes = readFile.size();
+
+    std::istringstream stream(std::string(readFile.data(), readFile.data() + readFile.size()));
+    std::string line;
+
+    while (std::getline(stream, line))
     {
-        case static_cast<int>(Game::Tag::PLAYER) :
-            scenes.back().players.back().loadTextures(materials, texFiles, cachedTextures);
-            break;
-        case static_cast<int>(Game::Tag::ENEMY) :
-            scenes.back().enemies.back().loadTextures(materials, texFiles, cachedTextures);
-            break;
-        case static_cast<int>(Game::Tag::PLATFORM) :
-            scenes.back().platforms.back().loadTextures(materials, texFiles, cachedTextures);
-            break;
-        default:
-            break;
-    }
-}
+        std::istringstream arguments(line);
+        std::string keyword;
+        if (!(arguments >> keyword) || keyword[0] == '#')
+            continue;
 
+        if (keyword == "newmtl")
+        {
+            materials.push_back(Material());
+            std::getline(arguments >> std::ws, materials.back().name);
+            while (!materials.back().name.empty() && materials.back().name.back() == '\r')
+                materials.back().name.pop_back();
+            continue;
+        }
 
+        // statements before the first newmtl have no material to go to
+        if (materials.empty())
+            continue;
+
+        Material& material = materials.back();
+        if (keyword == "Ka")
+            material.ambient = readColor(arguments);
+        else if (keyword == "Kd")
+            material.diffuse = readColor(arguments);
+        else if (keyword == "Ks")
+            material.specular = readColor(arguments);
+        else if (keyword == "Ns")
+            arguments >> material.shininess;
+        else if (keyword == "d")
+            arguments >> material.opacity;
+        else if (keyword == "Tr")
+        {
+            float transparency = 0.f;
+            if (arguments >> transparency)
+                material.opacity = 1.f - transparency;
+        }
+        else if (keyword == "map_Ka")
+            material.maps[int(Material::Map::AMBIENT)] = mapFile(arguments);
+        else if (keyword == "map_Kd")
+            material.maps[int(Material::Map::DIFFUSE)] = mapFile(arguments);
+        else if (keyword == "map_Ks")
+            material.maps[int(Material::Map::SPECULAR)] = mapFile(arguments);
+        else if (keyword == "map_Ns")
+            material.maps[int(Material::Map::SHININESS)] = mapFile(arguments);
+        else if (keyword == "map_d")
+            material.maps[int(Material::Map::OPACITY)] = mapFile(arguments);
+        else if (keyword == "map_Bump" || keyword == "map_bump" || keyword == "bump")
+            material.maps[int(Material::Map::BUMP)] = mapFile(arguments);
+    }
 
+    return true;
+}
@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
+#include <limits>
 
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_glfw.h>
@@ -7,12 +10,17 @@
 
 #include "core/debug/log.hpp"
 #include "resources/scene.hpp"
+#include "resources/textureregistry.hpp"
 #include "game/enemy.hpp"
 #include "game/player.hpp"
 
 using namespace Resources;
 using namespace Game;
 
+bool Scene::lodEnabled = true;
+float Scene::lodThreshold = 0.25f;
+float Scene::lodHysteresis = 0.15f;
+
 Scene::Scene(const std::string& scnName) : name(scnName)
 {}
 
@@ -102,6 +110,15 @@ void    Scene::updateGameObjects(const Game::Input& playerInputs)
 void Scene::draw(bool gameMode)
 {
     clearBackground();
+    trianglesDrawn = 0;
+    textureBinds = 0;
+    boundTexture = 0;
+    boundArray = 0;
+
+    GLint viewport[4] = { 0, 0, 0, 0 };
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    viewportHeight = float(viewport[3]);
+
     drawPlayers();
     drawGameObjects(gameMode);
 }
@@ -124,6 +141,11 @@ void Resources::Scene::drawPlayers()
                 else
                 {
                     drawModel(go.model, i);
+                    if (go.model.meshes[i].hasData())
+                    {
+                        trianglesDrawn += go.model.meshes[i].getData().getIndexCount() / 3;
+                        requestTextureDetail(go.model.meshes[i], go.transform);
+                    }
                 }
                     
             }
@@ -148,6 +170,14 @@ void Resources::Scene::drawGameObjects(bool gameMode)
                 }
                 else
                 {
+                    Resources::Mesh& mesh = go->model.meshes[i];
+                    if (mesh.hasData())
+                    {
+                        mesh.lod = selectLod(mesh, go->transform);
+                        trianglesDrawn += mesh.getData().getLevelIndexCount(mesh.lod) / 3;
+                        requestTextureDetail(mesh, go->transform);
+                    }
+
                     drawModel(go->model, i);
                     if (!gameMode && go->selected)
                     {
@@ -160,6 +190,48 @@ void Resources::Scene::drawGameObjects(bool gameMode)
     }
 }
 
+float Scene::screenSize(const Resources::Mesh& mesh, const Physics::Transform& transform) const
+{
+    const Resources::MeshData& data = mesh.getData();
+    float scale = std::max(transform.scale.x, std::max(transform.scale.y, transform.scale.z));
+    vec3 center = transform.position + data.getBoundsCenter() * transform.scale;
+    float radius = data.getBoundsRadius() * scale;
+    float distance = mag(center - camera.getCamPos());
+    if (distance <= radius)
+        return std::numeric_limits<float>::infinity();
+
+    return radius / (distance * std::tan(camera.getFovY() * 0.5f));
+}
+
+void Scene::requestTextureDetail(const Resources::Mesh& mesh, const Physics::Transform& transform) const
+{
+    if (!mesh.texture.handle.valid())
+        return;
+
+    // the texture spans the object once, its pixels on screen bound the texels worth keeping
+    float pixels = screenSize(mesh, transform) * viewportHeight;
+    Resources::TextureRegistry::getInstance().requestDetail(mesh.texture.handle, pixels);
+}
+
+int Scene::selectLod(const Resources::Mesh& mesh, const Physics::Transform& transform) const
+{
+    const Resources::MeshData& data = mesh.getData();
+    int levelCount = data.getLevelCount();
+    if (!lodEnabled || levelCount <= 1)
+        return 0;
+
+    float screenSize = this->screenSize(mesh, transform);
+    auto limit = [](int level) { return lodThreshold / float(1 << (level - 1)); };
+
+    int lod = std::min(mesh.lod, levelCount - 1);
+    while (lod + 1 < levelCount && screenSize < limit(lod + 1) * (1.f - lodHysteresis))
+        ++lod;
+    while (lod > 0 && screenSize > limit(lod) * (1.f + lodHysteresis))
+        --lod;
+
+    return lod;
+}
+
 void Resources::Scene::updateColliderPos()
 {
     for (auto& go : gameObjects)
@@ -188,15 +260,31 @@ void    Scene::clearBackground() const
 
 void	Scene::drawModel(LowRenderer::Model& model, int index, bool outlinePass, bool isCollider) const
 {
-    auto& rdrVertex = model.meshes[index].rdrVertices;
     auto& mesh = model.meshes[index];
+    if (!mesh.hasData())
+        return;
+
+    // the program of the pass is already bound by setModel
+    const Resources::Shader& shader = isCollider ? model.colliderShader : model.gfxShader;
+    shader.setVec3("positionScale", mesh.getData().getPositionScale());
+    shader.setVec3("positionOffset", mesh.getData().getPositionOffset());
+    if (!isCollider)
+    {
+        shader.setInt("materialIndex", int(mesh.material.index()));
+        shader.setBool("diffuseMapBound", mesh.texture.texCount != 0);
+
+        // packed textures are sampled from their array, the mesh texture otherwise
+        Resources::TextureSlot slot = mesh.texture.handle.slot();
+        shader.setInt("textureLayer", slot.array != 0 ? slot.layer : -1);
+        shader.setVec4("textureRect", Core::Maths::vec4(slot.rect[0], slot.rect[1], slot.rect[2], slot.rect[3]));
+    }
 
     if (isCollider)
     {
         if (model.colliderVisible)
         {
             glStencilMask(0x00);
-            drawCollider(mesh, rdrVertex);
+            drawCollider(mesh);
         }
     }
     else
@@ -206,7 +294,7 @@ void	Scene::drawModel(LowRenderer::Model& model, int index, bool outlinePass, bo
             glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
             glStencilMask(0x00);
             glDisable(GL_DEPTH_TEST);
-            drawGFX(mesh, model, rdrVertex);
+            drawGFX(mesh, model);
             glStencilMask(0xFF);
             glStencilFunc(GL_ALWAYS, 0, 0xFF);
             glEnable(GL_DEPTH_TEST);
@@ -215,47 +303,71 @@ void	Scene::drawModel(LowRenderer::Model& model, int index, bool outlinePass, bo
         {
             glStencilFunc(GL_ALWAYS, 1, 0xFF);
             glStencilMask(0xFF);
-            drawGFX(mesh, model, rdrVertex);
+            drawGFX(mesh, model);
         }
         
     }
     
 }
 
-void Resources::Scene::drawCollider(Resources::Mesh& mesh, std::vector<Core::rdrVertex>& rdrVertex) const
+void Resources::Scene::drawCollider(Resources::Mesh& mesh) const
 {
-    glBindTexture(GL_TEXTURE_2D, mesh.texture.texCount);
-    glBindVertexArray(mesh.VAO);
+    glBindVertexArray(mesh.getData().getVAO());
 
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    verifyFaceType(mesh, rdrVertex);
+    verifyFaceType(mesh);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 }
 
-void Resources::Scene::drawGFX(Resources::Mesh& mesh, LowRenderer::Model& model, std::vector<Core::rdrVertex>& rdrVertex) const
+void Resources::Scene::drawGFX(Resources::Mesh& mesh, LowRenderer::Model& model) const
 {
-    glBindTexture(GL_TEXTURE_2D, mesh.texture.texCount);
-    glBindVertexArray(mesh.VAO);
+    bindTexture(mesh);
+    glBindVertexArray(mesh.getData().getVAO());
 
     if (model.wireframe)
     {
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        verifyFaceType(mesh, rdrVertex);
+        verifyFaceType(mesh);
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
     else
-        verifyFaceType(mesh, rdrVertex);
+        verifyFaceType(mesh);
+}
+
+void Resources::Scene::bindTexture(const Resources::Mesh& mesh) const
+{
+    Resources::TextureSlot slot = mesh.texture.handle.slot();
+    if (slot.array != 0)
+    {
+        if (slot.array == boundArray)
+            return;
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, slot.array);
+        glActiveTexture(GL_TEXTURE0);
+        boundArray = slot.array;
+    }
+    else
+    {
+        if (mesh.texture.texCount == boundTexture)
+            return;
+
+        glBindTexture(GL_TEXTURE_2D, mesh.texture.texCount);
+        boundTexture = mesh.texture.texCount;
+    }
+
+    ++textureBinds;
 }
 
-void Resources::Scene::verifyFaceType(Resources::Mesh& mesh, std::vector<Core::rdrVertex>& rdrVertex) const
+void Resources::Scene::verifyFaceType(Resources::Mesh& mesh) const
 {
     switch (mesh.faceType)
     {
         case FaceType::TRIANGLE:
-            glDrawElements(GL_TRIANGLES, GLsizei(rdrVertex.size()), GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, GLsizei(mesh.getData().getLevelIndexCount(mesh.lod)), mesh.getData().getIndexType(), mesh.getData().getLevelOffset(mesh.lod));
             break;
         case FaceType::QUAD :
-            glDrawElements(GL_TRIANGLES, GLsizei(rdrVertex.size()), GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, GLsizei(mesh.getData().getLevelIndexCount(mesh.lod)), mesh.getData().getIndexType(), mesh.getData().getLevelOffset(mesh.lod));
             break;
         default:
             std::string statement = "attempt to draw invalid face type " + static_cast<int>(mesh.faceType);
@@ -325,6 +437,7 @@ void Scene::showImGuiControls()
         if (ImGui::CollapsingHeader("Scene Options", ImGuiTreeNodeFlags_DefaultOpen))
         {
             ImGui::ColorEdit3("Background", clearColor.e);
+            ImGui::Text("Triangles drawn: %d | texture binds: %d", int(trianglesDrawn), int(textureBinds));
         }
 
         ImGui::Separator();
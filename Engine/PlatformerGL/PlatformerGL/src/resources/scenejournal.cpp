@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "resources/scenejournal.hpp"
+#include "resources/scenesnapshot.hpp"
+#include "core/io/assetpack.hpp"
+#include "core/io/mappedfile.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Resources;
+
+size_t SceneJournal::compactRecords = 64;
+
+namespace
+{
+    const char      magic[4] = { 'P', 'G', 'L', 'J' };
+    const uint32_t  version = 1;
+    const size_t    headerBytes = sizeof(magic) + sizeof(uint32_t) + sizeof(uint64_t);
+
+    const size_t    modelValues = 10;
+    const size_t    colliderValues = 6;
+    // model index, values and health
+    const size_t    entryBytes = sizeof(uint32_t) + SceneState::stride * sizeof(float) + sizeof(int32_t);
+
+    void readState(const SceneData& data, SceneState& state)
+    {
+        state.values.assign(data.models.size() * SceneState::stride, 0.f);
+        state.health.assign(data.models.size(), 0);
+        for (size_t i = 0; i < data.models.size(); ++i)
+        {
+            const ModelInfo& model = data.models[i];
+            float* values = state.values.data() + i * SceneState::stride;
+            std::copy_n(model.attribs.begin(), std::min(model.attribs.size(), modelValues), values);
+            std::copy_n(model.colliderAttribs.begin(), std::min(model.colliderAttribs.size(), colliderValues), values + modelValues);
+            if (!model.gameObjectAttribs.empty())
+                state.health[i] = model.gameObjectAttribs[0];
+        }
+        state.camera = data.camera;
+    }
+
+    void applyModel(const float* values, int health, ModelInfo& model)
+    {
+        model.attribs.assign(values, values + modelValues);
+        model.colliderAttribs.assign(values + modelValues, values + SceneState::stride);
+        if (!model.gameObjectAttribs.empty())
+            model.gameObjectAttribs[0] = health;
+    }
+
+    template<typename T>
+    void appendBytes(std::vector<char>& bytes, const T* values, size_t count)
+    {
+        const char* data = reinterpret_cast<const char*>(values);
+        bytes.insert(bytes.end(), data, data + count * sizeof(T));
+    }
+
+    // the journal is written after its snapshot, the latest of both dates the save
+    std::filesystem::file_time_type lastWrite(const std::string& sceneName, bool streamed)
+    {
+        std::filesystem::file_time_type time = std::filesystem::file_time_type::min();
+        for (const std::string& file : { SceneSnapshot::savePath(sceneName, streamed), SceneJournal::path(sceneName, streamed) })
+        {
+            std::error_code error;
+            std::filesystem::file_time_type written = std::filesystem::last_write_time(file, error);
+            if (!error)
+                time = std::max(time, written);
+        }
+        return time;
+    }
+
+    template<typename T>
+    bool take(const char*& cursor, const char* end, T* values, size_t count)
+    {
+        if (size_t(end - cursor) / sizeof(T) < count)
+            return false;
+
+        std::memcpy(values, cursor, count * sizeof(T));
+        cursor += count * sizeof(T);
+        return true;
+    }
+}
+
+std::string SceneJournal::path(const std::string& sceneName, bool streamed)
+{
+    return "Bin/scenes/save_" + std::filesystem::path(sceneName).stem().string() + (streamed ? ".stream" : "") + ".pgljournal";
+}
+
+bool SceneJournal::latestIsStreamed(const std::string& sceneName)
+{
+    return lastWrite(sceneName, true) > lastWrite(sceneName, false);
+}
+
+void SceneJournal::replay(const std::string& name, SceneData& data, bool streamedSave)
+{
+    sceneName = name;
+    streamed = streamedSave;
+
+    Core::IO::MappedFile snapshot;
+    if (!snapshot.open(SceneSnapshot::savePath(name, streamed)))
+        return;
+
+    snapshotHash = Core::IO::AssetPack::hash(snapshot.data(), snapshot.size());
+    snapshotBytes = snapshot.size();
+    continuing = true;
+    snapshot.close();
+
+    // no save since the snapshot was written
+    std::string file = path(name, streamed);
+    Core::IO::MappedFile journal;
+    if (!journal.open(file))
+        return;
+
+    const char* cursor = journal.data();
+    const char* end = journal.data() + journal.size();
+    char fileMagic[4];
+    uint32_t fileVersion = 0;
+    uint64_t fileSnapshotHash = 0;
+    if (!take(cursor, end, fileMagic, sizeof(fileMagic)) || std::memcmp(fileMagic, magic, sizeof(magic)) != 0
+        || !take(cursor, end, &fileVersion, 1) || fileVersion != version || !take(cursor, end, &fileSnapshotHash, 1)
+        || fileSnapshotHash != snapshotHash)
+    {
+        std::string statement = "Scene journal: " + file + " does not belong to the saved snapshot, ignored";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return;
+    }
+
+    size_t applied = 0;
+    std::vector<float> values(SceneState::stride);
+    while (cursor < end)
+    {
+        // a save interrupted while appending leaves a record without its hash
+        const char* record = cursor;
+        uint32_t entryCount = 0;
+        uint32_t cameraCount = 0;
+        uint64_t recordHash = 0;
+        bool valid = take(cursor, end, &entryCount, 1) && take(cursor, end, &cameraCount, 1)
+            && size_t(end - cursor) >= cameraCount * sizeof(float) + size_t(entryCount) * entryBytes + sizeof(recordHash);
+        if (valid)
+        {
+            const char* hashed = cursor + cameraCount * sizeof(float) + size_t(entryCount) * entryBytes;
+            std::memcpy(&recordHash, hashed, sizeof(recordHash));
+            valid = recordHash == Core::IO::AssetPack::hash(record, size_t(hashed - record));
+        }
+
+        if (valid && cameraCount > 0)
+        {
+            data.camera.resize(cameraCount);
+            take(cursor, end, data.camera.data(), cameraCount);
+        }
+
+        for (uint32_t i = 0; valid && i < entryCount; ++i)
+        {
+            uint32_t index = 0;
+            int32_t health = 0;
+            take(cursor, end, &index, 1);
+            take(cursor, end, values.data(), values.size());
+            take(cursor, end, &health, 1);
+            valid = index < data.models.size();
+            if (valid)
+                applyModel(values.data(), health, data.models[index]);
+        }
+
+        if (!valid)
+        {
+            std::string statement = "Scene journal: " + file + " is torn after " + std::to_string(applied)
+                + " records, the next save rewrites the snapshot";
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+            records = compactRecords;
+            return;
+        }
+
+        cursor += sizeof(recordHash);
+        ++applied;
+    }
+
+    records = applied;
+    journalBytes = journal.size();
+
+    std::string statement = "Scene journal replayed: " + file + " | " + std::to_string(applied) + " records";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+}
+
+void SceneJournal::reset(const std::string& name, std::shared_ptr<const SceneData> data, bool streamedSource)
+{
+    // the journal indexes the records of its snapshot, which hold other objects in the files of the other kind
+    if (streamedSource != streamed)
+        continuing = false;
+
+    sceneName = name;
+    streamed = streamedSource;
+    source = std::move(data);
+    readState(*source, saved);
+}
+
+bool SceneJournal::commit(const SceneState& state)
+{
+    if (!source || state.values.size() != saved.values.size() || state.health.size() != saved.health.size())
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    bool rewrite = !continuing || records >= compactRecords || journalBytes > snapshotBytes;
+    size_t changed = source->models.size();
+    bool written = rewrite ? compact(state) : append(state, changed);
+    if (!written)
+    {
+        // the journal may end with a partial record, it is not appended to anymore
+        continuing = false;
+        return false;
+    }
+    saved = state;
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::string statement = "Scene saved: " + sceneName + " | " + std::to_string(changed) + " of "
+        + std::to_string(source->models.size()) + " models written to the " + (rewrite ? "snapshot" : "journal")
+        + " in " + std::to_string(elapsed.count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+
+    return true;
+}
+
+bool SceneJournal::append(const SceneState& state, size_t& changed)
+{
+    std::vector<char> record(2 * sizeof(uint32_t));
+    uint32_t cameraCount = state.camera != saved.camera ? uint32_t(state.camera.size()) : 0;
+    appendBytes(record, state.camera.data(), cameraCount);
+
+    uint32_t entryCount = 0;
+    for (size_t i = 0; i < state.health.size(); ++i)
+    {
+        const float* values = state.values.data() + i * SceneState::stride;
+        if (std::memcmp(values, saved.values.data() + i * SceneState::stride, SceneState::stride * sizeof(float)) == 0
+            && state.health[i] == saved.health[i])
+            continue;
+
+        uint32_t index = uint32_t(i);
+        int32_t health = state.health[i];
+        appendBytes(record, &index, 1);
+        appendBytes(record, values, SceneState::stride);
+        appendBytes(record, &health, 1);
+        ++entryCount;
+    }
+
+    changed = entryCount;
+    if (entryCount == 0 && cameraCount == 0)
+        return true;
+
+    std::memcpy(record.data(), &entryCount, sizeof(entryCount));
+    std::memcpy(record.data() + sizeof(entryCount), &cameraCount, sizeof(cameraCount));
+    uint64_t recordHash = Core::IO::AssetPack::hash(record.data(), record.size());
+    appendBytes(record, &recordHash, 1);
+
+    // a new journal replaces the one of the previous snapshot
+    std::string file = path(sceneName, streamed);
+    std::ofstream output(file, std::ios::out | std::ios::binary | (journalBytes == 0 ? std::ios::trunc : std::ios::app));
+    if (!output.is_open())
+    {
+        std::string statement = "Unable to write scene journal: " + file;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    if (journalBytes == 0)
+    {
+        output.write(magic, sizeof(magic));
+        output.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        output.write(reinterpret_cast<const char*>(&snapshotHash), sizeof(snapshotHash));
+        journalBytes = headerBytes;
+    }
+    output.write(record.data(), std::streamsize(record.size()));
+    output.flush();
+    if (!output.good())
+    {
+        std::string statement = "Unable to write scene journal: " + file;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    journalBytes += record.size();
+    ++records;
+    return true;
+}
+
+bool SceneJournal::compact(const SceneState& state)
+{
+    SceneData data = *source;
+    for (size_t i = 0; i < data.models.size(); ++i)
+        applyModel(state.values.data() + i * SceneState::stride, state.health[i], data.models[i]);
+    data.camera = state.camera;
+
+    std::string file = SceneSnapshot::savePath(sceneName, streamed);
+    if (!SceneSnapshot::save(file, data, state.compressed))
+        return false;
+
+    Core::IO::MappedFile snapshot;
+    if (!snapshot.open(file))
+        return false;
+
+    // a journal left by a crash before its removal no longer matches the hash
+    snapshotHash = Core::IO::AssetPack::hash(snapshot.data(), snapshot.size());
+    snapshotBytes = snapshot.size();
+    snapshot.close();
+
+    std::error_code error;
+    std::filesystem::remove(path(sceneName, streamed), error);
+    journalBytes = 0;
+    records = 0;
+    continuing = true;
+    return true;
+}
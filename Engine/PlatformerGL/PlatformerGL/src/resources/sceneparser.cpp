@@ -0,0 +1,385 @@
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "resources/sceneparser.hpp"
+#include "core/io/assetpack.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Resources;
+
+namespace
+{
+    // saves may end with a '\0'
+    inline bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\0';
+    }
+
+    inline bool isSeparator(char c)
+    {
+        return isBlank(c) || c == '/';
+    }
+
+    inline const char* skipSeparators(const char* p, const char* end)
+    {
+        while (p < end && isSeparator(*p))
+            ++p;
+        return p;
+    }
+
+    inline std::string_view nextToken(const char*& p, const char* end)
+    {
+        while (p < end && isBlank(*p))
+            ++p;
+        const char* begin = p;
+        while (p < end && !isBlank(*p))
+            ++p;
+        return std::string_view(begin, size_t(p - begin));
+    }
+
+    // every number left on the line, false on anything else
+    template <typename T>
+    bool parseNumbers(const char* p, const char* end, std::vector<T>& values)
+    {
+        for (p = skipSeparators(p, end); p < end; p = skipSeparators(p, end))
+        {
+            if (*p == '+')
+                ++p;
+
+            T value;
+            auto result = std::from_chars(p, end, value);
+            if (result.ec != std::errc() || (result.ptr < end && !isSeparator(*result.ptr)))
+                return false;
+
+            values.push_back(value);
+            p = result.ptr;
+        }
+        return true;
+    }
+
+    struct LineReporter
+    {
+        const std::string&  filename;
+        SceneData&          data;
+
+        void operator()(size_t line, const std::string& reason) const
+        {
+            ++data.errorCount;
+            std::string statement = filename + ":" + std::to_string(line) + ": " + reason + ", line skipped";
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        }
+    };
+
+    // transform (position/rotation/scale) and tag
+    const size_t modelValues = 10;
+    // center/extensions or omega/radius
+    const size_t colliderValues = 6;
+    const size_t cameraValues = 10;
+    // enabled/ambient/diffuse/specular then direction, position, attenuation and cutoff depending on the light
+    const size_t dirLightValues = 13;
+    const size_t pointLightValues = 16;
+    const size_t spotLightValues = 20;
+    // instances of one placement record
+    const size_t maxInstances = size_t(1) << 20;
+
+    // prefab offset and placement: positions and rotations add up, scales multiply
+    void placeInstance(const ModelInfo& prefab, const float* position, const float* rotation, const float* scale,
+        std::vector<ModelInfo>& models)
+    {
+        models.push_back(prefab);
+        std::vector<float>& attribs = models.back().attribs;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            attribs[i] += position[i];
+            if (rotation)
+                attribs[3 + i] += rotation[i];
+            if (scale)
+                attribs[6 + i] *= scale[i];
+        }
+    }
+
+    bool isCount(float value)
+    {
+        return value >= 1.f && value <= float(maxInstances) && value == std::floor(value);
+    }
+}
+
+bool SceneParser::parseFile(const std::string& filename, SceneData& data)
+{
+    Core::IO::AssetFile file;
+    if (!file.open(filename))
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    parse(file.data(), file.size(), filename, data);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::string statement = "Scene parsed: " + filename + " | " + std::to_string(data.lineCount) + " lines, "
+        + std::to_string(data.models.size()) + " models, " + std::to_string(data.errorCount) + " errors in "
+        + std::to_string(elapsed.count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+
+    return true;
+}
+
+void SceneParser::parse(const char* text, size_t size, const std::string& filename, SceneData& data)
+{
+    LineReporter report = { filename, data };
+
+    // game object attributes by tag code, the first record of a tag is kept
+    std::map<int, std::vector<int>> tagAttribs;
+    std::vector<size_t> modelLines;
+    bool modelSeen = false;
+    bool modelOpen = false;     // the records following a skipped "m" line are skipped with it
+
+    // defined prefabs, the one being read joins them at its "}" (a malformed header reads it under no name)
+    std::map<std::string, ModelInfo, std::less<>> prefabs;
+    ModelInfo prefab;
+    std::string prefabName;
+    size_t prefabLine = 0;
+    bool prefabOpen = false;
+
+    const char* end = text + size;
+    size_t lineNumber = 0;
+    for (const char* lineBegin = text; lineBegin < end; )
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', size_t(end - lineBegin)));
+        if (!lineEnd)
+            lineEnd = end;
+        ++lineNumber;
+
+        const char* p = lineBegin;
+        lineBegin = lineEnd + 1;
+
+        std::string_view keyword = nextToken(p, lineEnd);
+        if (keyword.empty() || keyword[0] == '#')
+            continue;
+
+        if (keyword == "m")
+        {
+            modelSeen = true;
+            if (prefabOpen && !prefab.name.empty())
+            {
+                report(lineNumber, "prefab " + prefabName + " holds one model");
+                modelOpen = false;
+                continue;
+            }
+
+            ModelInfo model;
+            model.name = std::string(nextToken(p, lineEnd));
+            modelOpen = !model.name.empty() && parseNumbers(p, lineEnd, model.attribs) && model.attribs.size() == modelValues;
+            if (!modelOpen)
+            {
+                report(lineNumber, "model record needs a name, 9 transform values and a tag code");
+                continue;
+            }
+
+            if (prefabOpen)
+            {
+                prefab = std::move(model);
+                continue;
+            }
+
+            data.models.push_back(std::move(model));
+            modelLines.push_back(lineNumber);
+        }
+        else if (keyword == "t" || keyword == "co" || keyword == "s")
+        {
+            if (!modelOpen)
+            {
+                if (!modelSeen)
+                    report(lineNumber, std::string(keyword) + " record before any model");
+                continue;
+            }
+
+            ModelInfo& model = prefabOpen ? prefab : data.models.back();
+            if (keyword == "t")
+            {
+                std::string_view texture = nextToken(p, lineEnd);
+                if (texture.empty())
+                    report(lineNumber, "texture record without a file");
+                else
+                    model.customTexture = std::string(texture);
+            }
+            else if (keyword == "co")
+            {
+                std::string_view collider = nextToken(p, lineEnd);
+                std::vector<float> values;
+                if (collider.empty() || !parseNumbers(p, lineEnd, values) || values.size() != colliderValues)
+                {
+                    report(lineNumber, "collider record needs a type and 6 values");
+                    continue;
+                }
+
+                model.colliderName = std::string(collider);
+                model.colliderAttribs = std::move(values);
+            }
+            else
+            {
+                std::string_view vertex = nextToken(p, lineEnd);
+                std::string_view fragment = nextToken(p, lineEnd);
+                if (fragment.empty() || !nextToken(p, lineEnd).empty())
+                {
+                    report(lineNumber, "shader record needs a vertex and a fragment file");
+                    continue;
+                }
+
+                model.shaders.emplace_back(vertex);
+                model.shaders.emplace_back(fragment);
+            }
+        }
+        else if (keyword == "prefab")
+        {
+            std::string_view name = nextToken(p, lineEnd);
+            std::string_view brace = nextToken(p, lineEnd);
+            if (prefabOpen)
+                report(prefabLine, "prefab " + prefabName + " is not closed");
+
+            modelOpen = false;
+            prefabOpen = true;
+            prefab = ModelInfo();
+            prefabLine = lineNumber;
+            prefabName.clear();
+            if (name.empty() || brace != "{" || !nextToken(p, lineEnd).empty())
+                report(lineNumber, "prefab record needs a name followed by {");
+            else
+                prefabName = std::string(name);
+        }
+        else if (keyword == "}")
+        {
+            if (!prefabOpen)
+            {
+                report(lineNumber, "} outside of a prefab");
+                continue;
+            }
+
+            prefabOpen = false;
+            modelOpen = false;
+            if (prefabName.empty())
+                continue;
+
+            if (prefab.name.empty() || prefab.colliderName.empty() || prefab.shaders.size() != 4)
+                report(prefabLine, "prefab " + prefabName + " needs a model with one collider and two shader records");
+            else
+                prefabs[prefabName] = std::move(prefab);
+        }
+        else if (keyword == "place" || keyword == "array" || keyword == "grid")
+        {
+            modelOpen = false;
+            std::string_view name = nextToken(p, lineEnd);
+            auto found = prefabs.find(name);
+            if (prefabOpen || found == prefabs.end())
+            {
+                report(lineNumber, std::string(keyword) + " record needs a prefab defined before it, outside of any prefab");
+                continue;
+            }
+
+            std::vector<float> values;
+            bool valid = parseNumbers(p, lineEnd, values);
+            const ModelInfo& source = found->second;
+            if (keyword == "place")
+            {
+                if (!valid || (values.size() != 3 && values.size() != 9))
+                {
+                    report(lineNumber, "place record needs a position, or a position, rotation and scale");
+                    continue;
+                }
+
+                bool full = values.size() == 9;
+                placeInstance(source, values.data(), full ? values.data() + 3 : nullptr, full ? values.data() + 6 : nullptr, data.models);
+                modelLines.push_back(lineNumber);
+                continue;
+            }
+
+            // start, step, then the count along the step or along each axis
+            bool grid = keyword == "grid";
+            valid = valid && values.size() == (grid ? 9 : 7);
+            for (size_t i = 6; valid && i < values.size(); ++i)
+                valid = isCount(values[i]);
+            size_t counts[3] = { valid ? size_t(values[6]) : 0, grid && valid ? size_t(values[7]) : 1, grid && valid ? size_t(values[8]) : 1 };
+            // each count is at most maxInstances, their product does not wrap in 64 bits on the 32 bit builds either
+            uint64_t instances = uint64_t(counts[0]) * uint64_t(counts[1]) * uint64_t(counts[2]);
+            if (!valid || instances > maxInstances)
+            {
+                report(lineNumber, grid ? "grid record needs a start, a step and 3 counts" : "array record needs a start, a step and a count");
+                continue;
+            }
+
+            data.models.reserve(data.models.size() + size_t(instances));
+            modelLines.reserve(modelLines.size() + size_t(instances));
+            for (size_t x = 0; x < counts[0]; ++x)
+            {
+                for (size_t y = 0; y < counts[1]; ++y)
+                {
+                    for (size_t z = 0; z < counts[2]; ++z)
+                    {
+                        // an array steps along the whole vector
+                        float steps[3] = { float(x), grid ? float(y) : float(x), grid ? float(z) : float(x) };
+                        float position[3];
+                        for (size_t i = 0; i < 3; ++i)
+                            position[i] = values[i] + steps[i] * values[3 + i];
+
+                        placeInstance(source, position, nullptr, nullptr, data.models);
+                        modelLines.push_back(lineNumber);
+                    }
+                }
+            }
+        }
+        else if (keyword == "c")
+        {
+            std::vector<float> values;
+            if (!parseNumbers(p, lineEnd, values) || values.size() != cameraValues)
+                report(lineNumber, "camera record needs 10 values");
+            else
+                data.camera = std::move(values);
+        }
+        else if (keyword == "ld" || keyword == "lp" || keyword == "ls")
+        {
+            std::vector<std::vector<float>>& lights = keyword == "ld" ? data.dirLights : keyword == "lp" ? data.pointLights : data.spotLights;
+            size_t expected = keyword == "ld" ? dirLightValues : keyword == "lp" ? pointLightValues : spotLightValues;
+
+            std::vector<float> values;
+            if (!parseNumbers(p, lineEnd, values) || values.size() != expected)
+                report(lineNumber, "light record " + std::string(keyword) + " needs " + std::to_string(expected) + " values");
+            else
+                lights.push_back(std::move(values));
+        }
+        else if (keyword == "0" || keyword == "1" || keyword == "2")
+        {
+            std::vector<int> values;
+            if (!parseNumbers(p, lineEnd, values))
+                report(lineNumber, "game object record needs integer attributes");
+            else
+                tagAttribs.emplace(keyword[0] - '0', std::move(values));
+        }
+        else
+        {
+            report(lineNumber, "unknown record " + std::string(keyword));
+        }
+    }
+    data.lineCount = lineNumber;
+    if (prefabOpen)
+        report(prefabLine, "prefab " + prefabName + " is not closed");
+
+    // a model needs its collider and both shader pairs to be built
+    size_t kept = 0;
+    for (size_t i = 0; i < data.models.size(); ++i)
+    {
+        ModelInfo& model = data.models[i];
+        if (model.colliderName.empty() || model.shaders.size() != 4)
+        {
+            report(modelLines[i], "model " + model.name + " needs one collider and two shader records");
+            continue;
+        }
+
+        model.gameObjectAttribs = tagAttribs[int(model.attribs.back())];
+        if (kept != i)
+            data.models[kept] = std::move(model);
+        ++kept;
+    }
+    data.models.resize(kept);
+}
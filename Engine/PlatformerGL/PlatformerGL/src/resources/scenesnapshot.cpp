@@ -0,0 +1,499 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include "resources/scenesnapshot.hpp"
+#include "core/io/compression.hpp"
+#include "core/io/mappedfile.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Resources;
+
+bool SceneSnapshot::compressed = true;
+const char* SceneSnapshot::extension = ".pglscene";
+
+namespace
+{
+    const char      magic[4] = { 'P', 'G', 'L', 'S' };
+    const uint32_t  version = 1;
+    const uint32_t  compressedFlag = 1;
+
+    // values per record, as checked by SceneParser
+    const size_t    modelValues = 10;
+    const size_t    colliderValues = 6;
+    const size_t    referencesPerModel = 7;     // name, collider, texture, 4 shaders
+    const size_t    bytesPerModel = 4 * (referencesPerModel + modelValues + colliderValues + 1);
+
+    // far above any level, a damaged header cannot ask for more
+    const uint64_t  maxPayloadBytes = uint64_t(1) << 30;
+
+    // bounds checked reads from the payload
+    struct Reader
+    {
+        const char* cursor;
+        const char* end;
+
+        template<typename T>
+        bool read(T& value)
+        {
+            return readArray(&value, 1);
+        }
+
+        template<typename T>
+        bool readArray(T* values, size_t count)
+        {
+            if (size_t(end - cursor) / sizeof(T) < count)
+                return false;
+
+            if (count > 0)
+                std::memcpy(values, cursor, count * sizeof(T));
+            cursor += count * sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string& value)
+        {
+            uint32_t length = 0;
+            if (!read(length) || size_t(end - cursor) < length)
+                return false;
+
+            value.assign(cursor, length);
+            cursor += length;
+            return true;
+        }
+
+        // count then values
+        template<typename T>
+        bool readVector(std::vector<T>& values)
+        {
+            uint32_t count = 0;
+            if (!read(count) || size_t(end - cursor) / sizeof(T) < count)
+                return false;
+
+            values.resize(count);
+            return readArray(values.data(), values.size());
+        }
+    };
+
+    struct Writer
+    {
+        std::vector<char>   bytes;
+
+        template<typename T>
+        void write(const T& value)
+        {
+            writeArray(&value, 1);
+        }
+
+        template<typename T>
+        void writeArray(const T* values, size_t count)
+        {
+            const char* data = reinterpret_cast<const char*>(values);
+            bytes.insert(bytes.end(), data, data + count * sizeof(T));
+        }
+
+        void writeString(const std::string& value)
+        {
+            write(uint32_t(value.size()));
+            bytes.insert(bytes.end(), value.begin(), value.end());
+        }
+
+        template<typename T>
+        void writeVector(const std::vector<T>& values)
+        {
+            write(uint32_t(values.size()));
+            writeArray(values.data(), values.size());
+        }
+    };
+
+    // lights of one kind, all of the same size, as one array
+    void writeLights(Writer& writer, const std::vector<std::vector<float>>& lights)
+    {
+        std::vector<float> flat;
+        for (const std::vector<float>& light : lights)
+            flat.insert(flat.end(), light.begin(), light.end());
+
+        writer.write(uint32_t(lights.size()));
+        writer.writeVector(flat);
+    }
+
+    bool readLights(Reader& reader, std::vector<std::vector<float>>& lights)
+    {
+        uint32_t count = 0;
+        std::vector<float> flat;
+        if (!reader.read(count) || !reader.readVector(flat)
+            || (count == 0 ? !flat.empty() : flat.size() < count || flat.size() % count != 0))
+            return false;
+
+        size_t values = count > 0 ? flat.size() / count : 0;
+        lights.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+            lights[i].assign(flat.begin() + i * values, flat.begin() + (i + 1) * values);
+        return true;
+    }
+
+    void appendNumber(std::string& line, float value)
+    {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        line.append(buffer, result.ptr);
+    }
+
+    // values separated by blanks, groups by a '/'
+    void appendGroups(std::string& line, const std::vector<float>& values, std::initializer_list<size_t> groups)
+    {
+        size_t index = 0;
+        for (size_t group : groups)
+        {
+            if (index > 0 && index < values.size())
+                line += '/';
+            for (size_t i = 0; i < group && index < values.size(); ++i, ++index)
+            {
+                if (i > 0)
+                    line += ' ';
+                appendNumber(line, values[index]);
+            }
+        }
+        // values past the groups, as the tag of a model
+        for (; index < values.size(); ++index)
+        {
+            line += ' ';
+            appendNumber(line, values[index]);
+        }
+    }
+
+    bool writeFile(const std::string& file, const char* data, size_t size)
+    {
+        std::error_code error;
+        std::filesystem::path path(file);
+        if (path.has_parent_path())
+            std::filesystem::create_directories(path.parent_path(), error);
+
+        // a crash while saving keeps the previous file
+        std::string temporary = file + ".tmp";
+        {
+            std::ofstream output(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!output.is_open())
+                return false;
+
+            output.write(data, std::streamsize(size));
+            if (!output.good())
+            {
+                output.close();
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporary, file, error);
+        if (error)
+        {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool SceneSnapshot::isSnapshot(const std::string& file)
+{
+    return std::filesystem::path(file).extension() == extension;
+}
+
+std::string SceneSnapshot::savePath(const std::string& sceneName, bool streamed)
+{
+    return "Bin/scenes/save_" + std::filesystem::path(sceneName).stem().string() + (streamed ? ".stream" : "") + extension;
+}
+
+bool SceneSnapshot::save(const std::string& file, const SceneData& data, bool compress)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // every asset reference once
+    std::vector<std::string> strings;
+    std::map<std::string, uint32_t> stringIndices;
+    auto reference = [&](const std::string& value)
+    {
+        auto found = stringIndices.emplace(value, uint32_t(strings.size()));
+        if (found.second)
+            strings.push_back(value);
+        return found.first->second;
+    };
+
+    size_t modelCount = data.models.size();
+    std::vector<uint32_t> references;
+    std::vector<float> transforms;
+    std::vector<float> colliders;
+    std::vector<uint32_t> attribCounts;
+    std::vector<int32_t> attribs;
+    references.reserve(modelCount * referencesPerModel);
+    transforms.reserve(modelCount * modelValues);
+    colliders.reserve(modelCount * colliderValues);
+    attribCounts.reserve(modelCount);
+
+    for (const ModelInfo& model : data.models)
+    {
+        if (model.attribs.size() != modelValues || model.colliderAttribs.size() != colliderValues || model.shaders.size() != 4)
+        {
+            std::string statement = "Scene snapshot: model " + model.name + " is incomplete, " + file + " not written";
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+            return false;
+        }
+
+        references.push_back(reference(model.name));
+        references.push_back(reference(model.colliderName));
+        references.push_back(reference(model.customTexture));
+        for (const std::string& shader : model.shaders)
+            references.push_back(reference(shader));
+
+        transforms.insert(transforms.end(), model.attribs.begin(), model.attribs.end());
+        colliders.insert(colliders.end(), model.colliderAttribs.begin(), model.colliderAttribs.end());
+        attribCounts.push_back(uint32_t(model.gameObjectAttribs.size()));
+        attribs.insert(attribs.end(), model.gameObjectAttribs.begin(), model.gameObjectAttribs.end());
+    }
+
+    Writer payload;
+    payload.write(uint32_t(strings.size()));
+    for (const std::string& value : strings)
+        payload.writeString(value);
+
+    payload.write(uint32_t(modelCount));
+    payload.writeArray(references.data(), references.size());
+    payload.writeArray(transforms.data(), transforms.size());
+    payload.writeArray(colliders.data(), colliders.size());
+    payload.writeArray(attribCounts.data(), attribCounts.size());
+    payload.writeVector(attribs);
+
+    payload.writeVector(data.camera);
+    writeLights(payload, data.dirLights);
+    writeLights(payload, data.pointLights);
+    writeLights(payload, data.spotLights);
+
+    Writer snapshot;
+    snapshot.writeArray(magic, sizeof(magic));
+    snapshot.write(version);
+    snapshot.write(compress ? compressedFlag : 0u);
+    snapshot.write(uint64_t(payload.bytes.size()));
+
+    if (compress)
+    {
+        std::vector<char> packed;
+        Core::IO::Compression::compress(payload.bytes.data(), payload.bytes.size(), packed);
+        snapshot.bytes.insert(snapshot.bytes.end(), packed.begin(), packed.end());
+    }
+    else
+    {
+        snapshot.bytes.insert(snapshot.bytes.end(), payload.bytes.begin(), payload.bytes.end());
+    }
+
+    if (!writeFile(file, snapshot.bytes.data(), snapshot.bytes.size()))
+    {
+        std::string statement = "Unable to write scene snapshot: " + file;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::string statement = "Scene snapshot saved: " + file + " | " + std::to_string(modelCount) + " models, "
+        + std::to_string(payload.bytes.size() / 1024) + " KB -> " + std::to_string(snapshot.bytes.size() / 1024) + " KB in "
+        + std::to_string(elapsed.count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+
+    return true;
+}
+
+bool SceneSnapshot::load(const std::string& file, SceneData& data)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Core::IO::MappedFile mapped;
+    if (!mapped.open(file))
+        return false;
+
+    Reader header = { mapped.data(), mapped.data() + mapped.size() };
+    char fileMagic[4];
+    uint32_t fileVersion = 0;
+    uint32_t flags = 0;
+    uint64_t payloadSize = 0;
+    if (!header.readArray(fileMagic, sizeof(fileMagic)) || std::memcmp(fileMagic, magic, sizeof(magic)) != 0
+        || !header.read(fileVersion) || fileVersion != version || !header.read(flags) || !header.read(payloadSize))
+    {
+        std::string statement = "Scene snapshot: " + file + " is not a version " + std::to_string(version) + " snapshot";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    std::vector<char> decompressed;
+    Reader reader = header;
+    if (flags & compressedFlag)
+    {
+        uint64_t compressedSize = uint64_t(header.end - header.cursor);
+        if (payloadSize > maxPayloadBytes || payloadSize > compressedSize * Core::IO::Compression::maxRatio)
+        {
+            std::string statement = "Scene snapshot: payload size out of range in " + file;
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+            return false;
+        }
+
+        decompressed.resize(size_t(payloadSize));
+        if (!Core::IO::Compression::decompress(header.cursor, size_t(header.end - header.cursor), decompressed.data(), decompressed.size()))
+        {
+            std::string statement = "Scene snapshot: corrupt payload in " + file;
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+            return false;
+        }
+        reader = { decompressed.data(), decompressed.data() + decompressed.size() };
+    }
+
+    SceneData snapshot;
+    // every string takes at least its length
+    uint32_t stringCount = 0;
+    bool valid = reader.read(stringCount) && size_t(reader.end - reader.cursor) / sizeof(uint32_t) >= stringCount;
+    std::vector<std::string> strings(valid ? stringCount : 0);
+    for (size_t i = 0; valid && i < strings.size(); ++i)
+        valid = reader.readString(strings[i]);
+
+    uint32_t modelCount = 0;
+    valid = valid && reader.read(modelCount) && size_t(reader.end - reader.cursor) / bytesPerModel >= modelCount;
+
+    std::vector<uint32_t> references(valid ? modelCount * referencesPerModel : 0);
+    std::vector<float> transforms(valid ? modelCount * modelValues : 0);
+    std::vector<float> colliders(valid ? modelCount * colliderValues : 0);
+    std::vector<uint32_t> attribCounts(valid ? modelCount : 0);
+    std::vector<int32_t> attribs;
+    valid = valid && reader.readArray(references.data(), references.size()) && reader.readArray(transforms.data(), transforms.size())
+        && reader.readArray(colliders.data(), colliders.size()) && reader.readArray(attribCounts.data(), attribCounts.size())
+        && reader.readVector(attribs) && reader.readVector(snapshot.camera)
+        && readLights(reader, snapshot.dirLights) && readLights(reader, snapshot.pointLights) && readLights(reader, snapshot.spotLights);
+
+    for (uint32_t reference : references)
+        valid = valid && reference < strings.size();
+
+    if (!valid)
+    {
+        std::string statement = "Scene snapshot: truncated or corrupt " + file;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    size_t attribOffset = 0;
+    snapshot.models.resize(modelCount);
+    for (size_t i = 0; i < modelCount; ++i)
+    {
+        ModelInfo& model = snapshot.models[i];
+        const uint32_t* modelReferences = references.data() + i * referencesPerModel;
+        model.name = strings[modelReferences[0]];
+        model.colliderName = strings[modelReferences[1]];
+        model.customTexture = strings[modelReferences[2]];
+        model.shaders.assign({ strings[modelReferences[3]], strings[modelReferences[4]], strings[modelReferences[5]], strings[modelReferences[6]] });
+
+        model.attribs.assign(transforms.begin() + i * modelValues, transforms.begin() + (i + 1) * modelValues);
+        model.colliderAttribs.assign(colliders.begin() + i * colliderValues, colliders.begin() + (i + 1) * colliderValues);
+
+        size_t count = std::min(size_t(attribCounts[i]), attribs.size() - attribOffset);
+        model.gameObjectAttribs.assign(attribs.begin() + attribOffset, attribs.begin() + attribOffset + count);
+        attribOffset += count;
+    }
+
+    data = std::move(snapshot);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::string statement = "Scene snapshot loaded: " + file + " | " + std::to_string(data.models.size()) + " models in "
+        + std::to_string(elapsed.count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+
+    return true;
+}
+
+bool SceneSnapshot::saveText(const std::string& file, const SceneData& data)
+{
+    std::string text;
+    std::string line;
+    std::map<int, const std::vector<int>*> tagAttribs;
+
+    for (const ModelInfo& model : data.models)
+    {
+        line = "m " + model.name + ' ';
+        appendGroups(line, model.attribs, { 3, 3, 3 });
+        text += line + '\n';
+
+        if (model.customTexture != "None")
+            text += "t " + model.customTexture + '\n';
+
+        line = "co " + model.colliderName + ' ';
+        appendGroups(line, model.colliderAttribs, { 3, 3 });
+        text += line + '\n';
+
+        for (size_t i = 0; i + 1 < model.shaders.size(); i += 2)
+            text += "s " + model.shaders[i] + ' ' + model.shaders[i + 1] + '\n';
+        text += '\n';
+
+        if (!model.attribs.empty())
+            tagAttribs.emplace(int(model.attribs.back()), &model.gameObjectAttribs);
+    }
+
+    if (!data.camera.empty())
+    {
+        line = "c ";
+        appendGroups(line, data.camera, { 3, 2, 3, 2 });
+        text += line + "\n\n";
+    }
+
+    const char* keywords[] = { "ld ", "lp ", "ls " };
+    const std::vector<std::vector<float>>* lights[] = { &data.dirLights, &data.pointLights, &data.spotLights };
+    for (size_t kind = 0; kind < 3; ++kind)
+    {
+        for (const std::vector<float>& light : *lights[kind])
+        {
+            line = keywords[kind];
+            if (kind == 0)
+                appendGroups(line, light, { 1, 3, 3, 3, 3 });
+            else if (kind == 1)
+                appendGroups(line, light, { 1, 3, 3, 3, 3, 3 });
+            else
+                appendGroups(line, light, { 1, 3, 3, 3, 3, 3, 3, 1 });
+            text += line + '\n';
+        }
+    }
+
+    if (!tagAttribs.empty())
+        text += '\n';
+    for (const auto& tag : tagAttribs)
+    {
+        line = std::to_string(tag.first);
+        for (int value : *tag.second)
+            line += ' ' + std::to_string(value);
+        text += line + '\n';
+    }
+
+    if (!writeFile(file, text.data(), text.size()))
+    {
+        std::string statement = "Unable to write scene: " + file;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+    return true;
+}
+
+bool SceneSnapshot::loadAny(const std::string& file, SceneData& data)
+{
+    return isSnapshot(file) ? load(file, data) : SceneParser::parseFile(file, data);
+}
+
+bool SceneSnapshot::convert(const std::string& source, const std::string& destination)
+{
+    SceneData data;
+    if (!loadAny(source, data))
+    {
+        std::string statement = "Scene conversion: unable to read " + source;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    return isSnapshot(destination) ? save(destination, data, compressed) : saveText(destination, data);
+}
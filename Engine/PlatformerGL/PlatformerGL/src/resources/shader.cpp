@@ -1,12 +1,11 @@
-#include <fstream>
-#include <sstream>
-
 #include "resources/shader.hpp"
 #include "core/debug/log.hpp"
+#include "core/debug/loadprofiler.hpp"
 
 using namespace Resources;
 
 Shader::Shader(const std::string& vertexFilename, const std::string& fragFilename, const Core::Maths::vec3& lightCounts)
+	: vertexFile(vertexFilename), fragFile(fragFilename), lightCounts(lightCounts), hasLightCounts(true)
 {
 	vertexShaderString = "Bin/shaders/" + vertexFilename;
 	fragShaderString = "Bin/shaders/" + fragFilename;
@@ -17,6 +16,7 @@ Shader::Shader(const std::string& vertexFilename, const std::string& fragFilenam
 }
 
 Shader::Shader(const std::string& vertexFilename, const std::string& fragFilename)
+	: vertexFile(vertexFilename), fragFile(fragFilename)
 {
 	vertexShaderString = "Bin/shaders/" + vertexFilename;
 	fragShaderString = "Bin/shaders/" + fragFilename;
@@ -38,6 +38,36 @@ void Shader::operator=(const Shader& other)
 	shaderProgram = other.shaderProgram;
 	fragShaderString = other.fragShaderString;
 	vertexShaderString = other.vertexShaderString;
+	vertexFile = other.vertexFile;
+	fragFile = other.fragFile;
+	lightCounts = other.lightCounts;
+	hasLightCounts = other.hasLightCounts;
+}
+
+bool	Shader::reload()
+{
+	GLuint previousProgram = shaderProgram;
+
+	vertexShaderString = "Bin/shaders/" + vertexFile;
+	fragShaderString = "Bin/shaders/" + fragFile;
+	failureLog = Core::Debug::LogType::WARNING;
+
+	initShader();
+	if (hasLightCounts)
+		getShaderSources(lightCounts);
+	else
+		getShaderSources();
+	bool compiled = initShaderProgram();
+
+	failureLog = Core::Debug::LogType::ERROR;
+
+	if (!compiled)
+	{
+		glDeleteProgram(shaderProgram);
+		shaderProgram = previousProgram;
+	}
+
+	return compiled;
 }
 
 void	Shader::initShader()
@@ -48,21 +78,26 @@ void	Shader::initShader()
 }
 
 
-void	Shader::initShaderProgram()
+bool	Shader::initShaderProgram()
 {
+	Core::Debug::LoadProfiler::Scope profile(Core::Debug::LoadStage::SHADER_COMPILE, vertexFile + " + " + fragFile);
+	profile.bytes = vertexShaderString.size() + fragShaderString.size();
+
 	const char* vertexShaderSource = vertexShaderString.c_str();
 	const char* fragShaderSource = fragShaderString.c_str();
 
 	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
 	glCompileShader(vertexShader);
 	int success;
+	bool compiled = true;
 	char infoLog[512];
 	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
 	if (!success)
 	{
 		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
 		std::string statement = "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" + std::string(infoLog);
-		Core::Debug::Log::print( statement, Core::Debug::LogType::ERROR);
+		Core::Debug::Log::print( statement, failureLog);
+		compiled = false;
 	}
 
 	glShaderSource(fragmentShader, 1, &fragShaderSource, NULL);
@@ -72,7 +107,8 @@ void	Shader::initShaderProgram()
 	{
 		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
 		std::string statement = "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" + std::string(infoLog);
-		Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
+		Core::Debug::Log::print(statement, failureLog);
+		compiled = false;
 	}
 
 	glAttachShader(shaderProgram, vertexShader);
@@ -82,24 +118,24 @@ void	Shader::initShaderProgram()
 	if (!success) {
 		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
 		std::string statement = "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" + std::string(infoLog);
-		Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
+		Core::Debug::Log::print(statement, failureLog);
+		compiled = false;
 	}
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
+
+	return compiled;
 }
 
 void	Shader::getShaderSources()
 {
-	std::ifstream vertexFile(vertexShaderString);
-	std::ifstream fragmentFile(fragShaderString);
+	Core::IO::AssetFile vertexFile(vertexShaderString);
+	Core::IO::AssetFile fragmentFile(fragShaderString);
 
 	verifyFiles(vertexFile, fragmentFile);
 
-	std::string vertexFileContent((std::istreambuf_iterator<char>(vertexFile)), std::istreambuf_iterator<char>());
-	std::string fragFileContent((std::istreambuf_iterator<char>(fragmentFile)), std::istreambuf_iterator<char>());
-
-	vertexFile.close();
-	fragmentFile.close();
+	std::string vertexFileContent(vertexFile.data(), vertexFile.data() + vertexFile.size());
+	std::string fragFileContent(fragmentFile.data(), fragmentFile.data() + fragmentFile.size());
 
 	vertexShaderString = vertexFileContent;
 	fragShaderString = fragFileContent;
@@ -107,16 +143,13 @@ void	Shader::getShaderSources()
 
 void	Shader::getShaderSources(const Core::Maths::vec3& lightCounts)
 {
-	std::ifstream vertexFile(vertexShaderString);
-	std::ifstream fragmentFile(fragShaderString);
+	Core::IO::AssetFile vertexFile(vertexShaderString);
+	Core::IO::AssetFile fragmentFile(fragShaderString);
 
 	verifyFiles(vertexFile, fragmentFile);
 
-	std::string vertexFileContent((std::istreambuf_iterator<char>(vertexFile)), std::istreambuf_iterator<char>());
-	std::string fragFileContent((std::istreambuf_iterator<char>(fragmentFile)), std::istreambuf_iterator<char>());
-
-	vertexFile.close();
-	fragmentFile.close();
+	std::string vertexFileContent(vertexFile.data(), vertexFile.data() + vertexFile.size());
+	std::string fragFileContent(fragmentFile.data(), fragmentFile.data() + fragmentFile.size());
 
 
 	std::string replacing = "#define NR_DIR_LIGHTS 00";
@@ -156,17 +189,17 @@ void Resources::Shader::setShaderLightCount(std::string& fragFileContent, std::s
 	fragFileContent.replace(pos, lightCount.size(), lightCount);
 }
 
-void Resources::Shader::verifyFiles(std::ifstream& vertexFile, std::ifstream& fragmentFile)
+void Resources::Shader::verifyFiles(const Core::IO::AssetFile& vertexFile, const Core::IO::AssetFile& fragmentFile)
 {
 	std::string statement = "Vertex shader: " + vertexShaderString;
 	Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
 	statement = "Fragment shader: " + fragShaderString;
 	Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
 
-	if (!vertexFile.is_open() || !fragmentFile.is_open())
+	if (!vertexFile.isOpen() || !fragmentFile.isOpen())
 	{
 		std::string statement = "A Shader file failed to open";
-		Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
+		Core::Debug::Log::print(statement, failureLog);
 	}
 }
 
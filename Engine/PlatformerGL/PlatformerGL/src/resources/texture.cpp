@@ -1,13 +1,106 @@
+#include <algorithm>
+#include <cstdint>
+
 #include <glad/glad.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_SSE2
+#include <emmintrin.h>
+#endif
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <STB_IMAGE/stb_image.h>
 
 #include "resources/texture.hpp"
+#include "core/io/assetpack.hpp"
 #include "core/debug/log.hpp"
 
 using namespace Resources;
 
+namespace
+{
+    size_t mipChainSize(int width, int height, int channels)
+    {
+        size_t size = 0;
+        while (true)
+        {
+            size += size_t(width) * size_t(height) * size_t(channels);
+            if (width == 1 && height == 1)
+                return size;
+
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+    }
+
+    // adds two source rows into 16 bit lanes, the vertical half of the box filter
+    void sumRows(const unsigned char* row0, const unsigned char* row1, uint16_t* sums, size_t count)
+    {
+        size_t i = 0;
+#ifdef TEXTURE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + i));
+            __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i + 8), high);
+        }
+#endif
+        for (; i < count; ++i)
+            sums[i] = uint16_t(row0[i] + row1[i]);
+    }
+
+    // adds neighbour pixels of the summed rows and writes the rounded average, the horizontal half
+    void averageColumns(const uint16_t* sums, int srcWidth, unsigned char* out, int dstWidth, int channels)
+    {
+        int x = 0;
+#ifdef TEXTURE_SSE2
+        if (channels == 4)
+        {
+            // two output pixels from four source pixels per step
+            const __m128i rounding = _mm_set1_epi16(2);
+            for (; x + 1 < dstWidth && 2 * x + 3 < srcWidth; x += 2)
+            {
+                __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + size_t(x) * 8));
+                __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + size_t(x) * 8 + 8));
+                __m128i s0 = _mm_add_epi16(v0, _mm_srli_si128(v0, 8));
+                __m128i s1 = _mm_add_epi16(v1, _mm_srli_si128(v1, 8));
+                __m128i average = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s0, s1), rounding), 2);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + size_t(x) * 4), _mm_packus_epi16(average, average));
+            }
+        }
+#endif
+        for (; x < dstWidth; ++x)
+        {
+            const uint16_t* a = sums + size_t(std::min(2 * x, srcWidth - 1)) * channels;
+            const uint16_t* b = sums + size_t(std::min(2 * x + 1, srcWidth - 1)) * channels;
+            for (int c = 0; c < channels; ++c)
+                out[size_t(x) * channels + c] = static_cast<unsigned char>((a[c] + b[c] + 2) >> 2);
+        }
+    }
+
+    // 2x2 box filter, the last row or column of odd sizes is repeated
+    void downsample(const unsigned char* src, int srcWidth, int srcHeight,
+        unsigned char* dst, int dstWidth, int dstHeight, int channels)
+    {
+        size_t srcPitch = size_t(srcWidth) * channels;
+        size_t dstPitch = size_t(dstWidth) * channels;
+        std::vector<uint16_t> sums(srcPitch);
+
+        for (int y = 0; y < dstHeight; ++y)
+        {
+            const unsigned char* row0 = src + size_t(std::min(2 * y, srcHeight - 1)) * srcPitch;
+            const unsigned char* row1 = src + size_t(std::min(2 * y + 1, srcHeight - 1)) * srcPitch;
+
+            sumRows(row0, row1, sums.data(), srcPitch);
+            averageColumns(sums.data(), srcWidth, dst + size_t(y) * dstPitch, dstWidth, channels);
+        }
+    }
+}
+
 Texture::Texture()
 {
     texCount = 0;
@@ -25,6 +118,7 @@ void Texture::operator=(const Texture& other)
     texCount = other.texCount;
     width = other.width;
     height = other.height;
+    handle = other.handle;
 }
 
 unsigned int    Texture::bindTexture()
@@ -40,30 +134,116 @@ unsigned int    Texture::bindTexture()
 }
 
 void Texture::processTexData(const std::string& textureFile)
+{
+    TextureImage image;
+    if (decode(textureFile, image))
+        generateMips(image);
+    upload(textureFile, image);
+}
+
+bool Texture::decode(const std::string& textureFile, TextureImage& image)
 {
     std::string filename = "Assets/textures/" + textureFile;
-    unsigned char* data = loadImage(filename, width, height);
+    stbi_set_flip_vertically_on_load_thread(1);
+
+    Core::IO::AssetFile file;
+    if (!file.open(filename) || file.size() == 0)
+        return false;
+
+    // kept in the channel count of the file
+    int width = 0, height = 0, channels = 0;
+    unsigned char* data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.data()), int(file.size()),
+        &width, &height, &channels, 0);
+    if (!data)
+        return false;
+
+    size_t size = size_t(width) * size_t(height) * size_t(channels);
+    image.channels = channels;
+    image.levels.assign(1, { width, height, 0 });
+    image.pixels.reserve(mipChainSize(width, height, channels));
+    image.pixels.assign(data, data + size);
+    stbi_image_free(data);
+
+    return true;
+}
 
-    if (data)
+void Texture::generateMips(TextureImage& image)
+{
+    if (!image.valid())
+        return;
+
+    image.levels.resize(1);
+    image.pixels.resize(mipChainSize(image.levels[0].width, image.levels[0].height, image.channels));
+
+    while (image.levels.back().width > 1 || image.levels.back().height > 1)
     {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        TextureImage::Level source = image.levels.back();
+
+        TextureImage::Level level;
+        level.width = std::max(source.width / 2, 1);
+        level.height = std::max(source.height / 2, 1);
+        level.offset = source.offset + size_t(source.width) * size_t(source.height) * image.channels;
+
+        downsample(image.pixels.data() + source.offset, source.width, source.height,
+            image.pixels.data() + level.offset, level.width, level.height, image.channels);
+        image.levels.push_back(level);
     }
-    else
+}
+
+void Texture::upload(const std::string& textureFile, const TextureImage& image, int firstLevel)
+{
+    if (!image.valid())
     {
+        width = 0;
+        height = 0;
+
         std::string statement = "Failed to load texture: " + textureFile;
         Core::Debug::Log::print(statement, Core::Debug::LogType::ERROR);
+        return;
     }
-    stbi_image_free(data);
-    debug(textureFile);
 
+    firstLevel = std::clamp(firstLevel, 0, int(image.levels.size()) - 1);
+    width = image.levels[firstLevel].width;
+    height = image.levels[firstLevel].height;
 
-}
+    const GLenum formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+    const GLint internalFormats[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+    int format = std::clamp(image.channels, 1, 4) - 1;
 
-unsigned char* Texture::loadImage(std::string& filename, int& width, int& height)
-{
-    stbi_set_flip_vertically_on_load(1);
-    return stbi_load(filename.c_str(), &width, &height, nullptr, 4);
+    // a texture streamed again may hold a longer chain than the new one
+    GLint previousMaxLevel = 0;
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &previousMaxLevel);
+
+    // rows of 1 and 3 channel levels are not 4 bytes aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t i = size_t(firstLevel); i < image.levels.size(); ++i)
+    {
+        const TextureImage::Level& level = image.levels[i];
+        glTexImage2D(GL_TEXTURE_2D, GLint(i) - firstLevel, internalFormats[format], level.width, level.height, 0,
+            formats[format], GL_UNSIGNED_BYTE, image.levelData(i));
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    GLint levelCount = GLint(image.levels.size()) - firstLevel;
+
+    // empty images release the levels past the new chain, 16 levels cover the largest textures
+    for (GLint level = levelCount; level <= std::min(previousMaxLevel, 15); ++level)
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormats[format], 0, 0, 0, formats[format], GL_UNSIGNED_BYTE, nullptr);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+    // grey and grey alpha images are sampled as rgb like the others
+    const GLint swizzles[4][4] = {
+        { GL_RED, GL_RED, GL_RED, GL_ONE },
+        { GL_RED, GL_RED, GL_RED, GL_GREEN },
+        { GL_RED, GL_GREEN, GL_BLUE, GL_ONE },
+        { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA }
+    };
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzles[format]);
+
+    debug(textureFile);
 }
 
 void Texture::debug(const std::string& textureFile)
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <tuple>
+
+#include <glad/glad.h>
+#include <imgui/imgui.h>
+
+#include "resources/texturepacker.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Resources;
+
+bool TexturePacker::enabled = true;
+int TexturePacker::atlasSize = 2048;
+int TexturePacker::atlasPadding = 8;
+int TexturePacker::atlasMaxTexture = 512;
+
+namespace
+{
+    struct Source
+    {
+        unsigned int            texture;
+        TextureSlot*            slot;
+        GLint                   width;
+        GLint                   height;
+        GLint                   format;
+        GLint                   levels;
+        int                     channels;
+    };
+
+    int channelCount(GLint internalFormat)
+    {
+        switch (internalFormat)
+        {
+            case GL_R8:
+                return 1;
+            case GL_RG8:
+                return 2;
+            case GL_RGB8:
+                return 3;
+            case GL_RGBA8:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    size_t levelBytes(GLint width, GLint height, GLint levels, int channels)
+    {
+        size_t bytes = 0;
+        for (GLint level = 0; level < levels; ++level)
+            bytes += size_t(std::max(width >> level, 1)) * size_t(std::max(height >> level, 1)) * size_t(channels);
+        return bytes;
+    }
+
+    // same sampling as the textures they come from, see Texture::upload
+    void setSampling(GLint levels, GLint wrap)
+    {
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    }
+
+    void setSwizzle(int channels)
+    {
+        const GLint swizzles[4][4] = {
+            { GL_RED, GL_RED, GL_RED, GL_ONE },
+            { GL_RED, GL_RED, GL_RED, GL_GREEN },
+            { GL_RED, GL_GREEN, GL_BLUE, GL_ONE },
+            { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA }
+        };
+        glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzles[std::clamp(channels, 1, 4) - 1]);
+    }
+
+    // the swizzle of the source applied on the CPU, atlas pages are plain RGBA
+    unsigned char* expandToRgba(const unsigned char* texel, int channels, unsigned char* rgba)
+    {
+        switch (channels)
+        {
+            case 1:
+                rgba[0] = rgba[1] = rgba[2] = texel[0];
+                rgba[3] = 255;
+                break;
+            case 2:
+                rgba[0] = rgba[1] = rgba[2] = texel[0];
+                rgba[3] = texel[1];
+                break;
+            case 3:
+                rgba[0] = texel[0];
+                rgba[1] = texel[1];
+                rgba[2] = texel[2];
+                rgba[3] = 255;
+                break;
+            default:
+                std::copy(texel, texel + 4, rgba);
+                break;
+        }
+        return rgba + 4;
+    }
+
+    inline int wrap(int value, int size)
+    {
+        return ((value % size) + size) % size;
+    }
+}
+
+void TexturePacker::clear(const std::vector<TextureHandle::Entry*>& entries)
+{
+    for (TextureHandle::Entry* entry : entries)
+        entry->slot = TextureSlot();
+
+    if (!arrays.empty())
+        glDeleteTextures(GLsizei(arrays.size()), arrays.data());
+    arrays.clear();
+
+    arrayCount = 0;
+    layerCount = 0;
+    atlasTextures = 0;
+    atlasPages = 0;
+    unpacked = 0;
+    bytes = 0;
+}
+
+void TexturePacker::pack(const std::vector<TextureHandle::Entry*>& entries)
+{
+    auto start = std::chrono::steady_clock::now();
+    clear(entries);
+
+    std::vector<Source> sources;
+    for (TextureHandle::Entry* entry : entries)
+    {
+        Source source = { entry->texture, &entry->slot, 0, 0, 0, 0, 0 };
+        GLint maxLevel = 0;
+
+        glBindTexture(GL_TEXTURE_2D, source.texture);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &source.width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &source.height);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &source.format);
+        glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+        source.levels = maxLevel + 1;
+        source.channels = channelCount(source.format);
+
+        if (source.width > 0 && source.height > 0 && source.channels > 0)
+            sources.push_back(source);
+        else
+            ++unpacked;
+    }
+
+    // same size, format and mip chain: the layers of one array
+    std::map<std::tuple<GLint, GLint, GLint, GLint>, std::vector<const Source*>> groups;
+    for (const Source& source : sources)
+        groups[std::make_tuple(source.width, source.height, source.format, source.levels)].push_back(&source);
+
+    std::vector<const Source*> atlasSources;
+    for (const auto& group : groups)
+    {
+        const std::vector<const Source*>& layers = group.second;
+        const Source& first = *layers.front();
+
+        if (layers.size() < 2)
+        {
+            if (first.width <= atlasMaxTexture && first.height <= atlasMaxTexture)
+                atlasSources.push_back(&first);
+            else
+                ++unpacked;
+            continue;
+        }
+
+        GLuint array = 0;
+        glGenTextures(1, &array);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, first.levels, GLenum(first.format), first.width, first.height, GLsizei(layers.size()));
+
+        // copied on the GPU, the mip chains come along
+        for (size_t layer = 0; layer < layers.size(); ++layer)
+        {
+            for (GLint level = 0; level < first.levels; ++level)
+            {
+                glCopyImageSubData(layers[layer]->texture, GL_TEXTURE_2D, level, 0, 0, 0,
+                    array, GL_TEXTURE_2D_ARRAY, level, 0, 0, GLint(layer),
+                    std::max(first.width >> level, 1), std::max(first.height >> level, 1), 1);
+            }
+
+            TextureSlot& slot = *layers[layer]->slot;
+            slot.array = array;
+            slot.layer = int(layer);
+        }
+
+        setSampling(first.levels, GL_REPEAT);
+        setSwizzle(first.channels);
+
+        arrays.push_back(array);
+        ++arrayCount;
+        layerCount += layers.size();
+        bytes += levelBytes(first.width, first.height, first.levels, first.channels) * layers.size();
+    }
+
+    // the others on shelves of atlas pages, tallest first
+    std::sort(atlasSources.begin(), atlasSources.end(), [](const Source* a, const Source* b)
+    {
+        return a->height > b->height;
+    });
+
+    struct Placement
+    {
+        const Source*   source;
+        int             page;
+        int             x;
+        int             y;
+    };
+
+    std::vector<Placement> placements;
+    int x = 0, y = 0, shelf = 0, page = 0;
+    for (const Source* source : atlasSources)
+    {
+        int cellWidth = source->width + 2 * atlasPadding;
+        int cellHeight = source->height + 2 * atlasPadding;
+        if (cellWidth > atlasSize || cellHeight > atlasSize)
+        {
+            ++unpacked;
+            continue;
+        }
+
+        if (x + cellWidth > atlasSize)
+        {
+            x = 0;
+            y += shelf;
+            shelf = 0;
+        }
+        if (y + cellHeight > atlasSize)
+        {
+            ++page;
+            x = y = shelf = 0;
+        }
+
+        placements.push_back({ source, page, x + atlasPadding, y + atlasPadding });
+        x += cellWidth;
+        shelf = std::max(shelf, cellHeight);
+    }
+
+    if (!placements.empty())
+    {
+        // below this level the padding is less than a texel and neighbours bleed in
+        GLint levels = 1;
+        while ((atlasPadding >> levels) >= 1 && (atlasSize >> levels) >= 1)
+            ++levels;
+
+        GLsizei pages = GLsizei(page + 1);
+        GLuint atlas = 0;
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, atlasSize, atlasSize, pages);
+
+        std::vector<unsigned char> pixels;
+        std::vector<unsigned char> tile;
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        for (const Placement& placement : placements)
+        {
+            const Source& source = *placement.source;
+            pixels.resize(size_t(source.width) * size_t(source.height) * size_t(source.channels));
+
+            const GLenum formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+            glBindTexture(GL_TEXTURE_2D, source.texture);
+            glGetTexImage(GL_TEXTURE_2D, 0, formats[source.channels - 1], GL_UNSIGNED_BYTE, pixels.data());
+
+            // the border repeats the opposite edges, as the texture did with GL_REPEAT
+            int tileWidth = source.width + 2 * atlasPadding;
+            int tileHeight = source.height + 2 * atlasPadding;
+            tile.resize(size_t(tileWidth) * size_t(tileHeight) * 4);
+            unsigned char* out = tile.data();
+            for (int ty = 0; ty < tileHeight; ++ty)
+            {
+                const unsigned char* row = pixels.data() + size_t(wrap(ty - atlasPadding, source.height)) * source.width * source.channels;
+                for (int tx = 0; tx < tileWidth; ++tx)
+                    out = expandToRgba(row + size_t(wrap(tx - atlasPadding, source.width)) * source.channels, source.channels, out);
+            }
+
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, placement.x - atlasPadding, placement.y - atlasPadding, placement.page,
+                tileWidth, tileHeight, 1, GL_RGBA, GL_UNSIGNED_BYTE, tile.data());
+
+            TextureSlot& slot = *source.slot;
+            slot.array = atlas;
+            slot.layer = placement.page;
+            slot.rect[0] = float(placement.x) / float(atlasSize);
+            slot.rect[1] = float(placement.y) / float(atlasSize);
+            slot.rect[2] = float(source.width) / float(atlasSize);
+            slot.rect[3] = float(source.height) / float(atlasSize);
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        // the shader wraps the uvs inside the rect
+        setSampling(levels, GL_CLAMP_TO_EDGE);
+
+        arrays.push_back(atlas);
+        atlasTextures = placements.size();
+        atlasPages = size_t(pages);
+        bytes += levelBytes(atlasSize, atlasSize, levels, 4) * size_t(pages);
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::string statement = "Textures packed: " + std::to_string(layerCount) + " layers in " + std::to_string(arrayCount) + " arrays | "
+        + std::to_string(atlasTextures) + " textures in " + std::to_string(atlasPages) + " atlas pages | "
+        + std::to_string(unpacked) + " unpacked | " + std::to_string(bytes / 1024) + " KB in " + std::to_string(elapsed.count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+}
+
+void TexturePacker::showImGuiControls()
+{
+    ImGui::Checkbox("Pack textures", &enabled);
+    ImGui::Text("Texture arrays: %d (%d layers) | atlas: %d textures, %d pages | unpacked: %d | %.2f MB",
+        int(arrayCount), int(layerCount), int(atlasTextures), int(atlasPages), int(unpacked), float(bytes) / (1024.f * 1024.f));
+}
@@ -0,0 +1,448 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+#include <glad/glad.h>
+#include <imgui/imgui.h>
+
+#include "resources/textureregistry.hpp"
+#include "resources/texture.hpp"
+#include "resources/texturestreamer.hpp"
+#include "resources/texturepacker.hpp"
+#include "core/debug/log.hpp"
+#include "core/debug/loadprofiler.hpp"
+
+using namespace Resources;
+
+size_t TextureRegistry::budget = 256 * 1024 * 1024;
+bool TextureRegistry::csvEnabled = false;
+bool TextureRegistry::mipStreaming = true;
+float TextureRegistry::mipBias = 0.f;
+int TextureRegistry::unseenSize = 64;
+unsigned int TextureRegistry::mipDropDelay = 120;
+unsigned int TextureRegistry::mipRequestsPerFrame = 4;
+unsigned int TextureRegistry::repackDelay = 60;
+
+namespace
+{
+    // same file whatever the spelling used by the MTL files or the scene
+    std::string canonicalPath(const std::string& textureFile)
+    {
+        std::filesystem::path path = std::filesystem::path("Assets/textures") / textureFile;
+
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        if (error)
+            canonical = path.lexically_normal();
+
+        return canonical.generic_string();
+    }
+}
+
+TextureHandle::TextureHandle(Entry* entry)
+    : entry(entry)
+{
+    if (entry)
+        ++entry->refCount;
+}
+
+TextureHandle::TextureHandle(const TextureHandle& other)
+    : TextureHandle(other.entry)
+{
+}
+
+TextureHandle::~TextureHandle()
+{
+    if (entry)
+        TextureRegistry::getInstance().release(entry);
+}
+
+void TextureHandle::operator=(const TextureHandle& other)
+{
+    if (entry == other.entry)
+        return;
+
+    if (other.entry)
+        ++other.entry->refCount;
+    if (entry)
+        TextureRegistry::getInstance().release(entry);
+
+    entry = other.entry;
+}
+
+unsigned int TextureHandle::id() const
+{
+    return entry ? entry->texture : 0;
+}
+
+TextureSlot TextureHandle::slot() const
+{
+    return entry ? entry->slot : TextureSlot();
+}
+
+TextureHandle TextureRegistry::acquire(const std::string& textureFile)
+{
+    std::string path = canonicalPath(textureFile);
+
+    auto found = entries.find(path);
+    if (found != entries.end())
+    {
+        ++hits;
+        Core::Debug::LoadProfiler::getInstance().cacheHit("textures");
+        found->second.lastUsed = frame;
+
+        // only the referenced textures are packed
+        if (found->second.refCount == 0)
+            packingDirty = true;
+        return TextureHandle(&found->second);
+    }
+
+    ++misses;
+    Core::Debug::LoadProfiler::getInstance().cacheMiss("textures");
+
+    // decoded in the background, the placeholder is replaced by TextureStreamer::processUploads
+    TextureHandle::Entry& entry = entries[path];
+    entry.path = path;
+    entry.file = textureFile;
+    entry.texture = TextureStreamer::getInstance().request(textureFile);
+    entry.bytes = 4;    // 1x1 rgba placeholder
+    entry.lastUsed = frame;
+    residentBytes += entry.bytes;
+    packingDirty = true;
+
+    return TextureHandle(&entry);
+}
+
+bool TextureRegistry::reload(const std::string& textureFile)
+{
+    auto found = entries.find(canonicalPath(textureFile));
+    if (found == entries.end())
+        return false;
+
+    // no eviction while the upload is queued on its name
+    TextureHandle::Entry& entry = found->second;
+    entry.streaming = true;
+    TextureStreamer::getInstance().reload(entry.file, entry.texture);
+
+    return true;
+}
+
+TextureHandle::Entry* TextureRegistry::find(unsigned int texture)
+{
+    for (auto& it : entries)
+    {
+        if (it.second.texture == texture)
+            return &it.second;
+    }
+
+    return nullptr;
+}
+
+void TextureRegistry::requestDetail(const TextureHandle& handle, float pixels)
+{
+    TextureHandle::Entry* entry = handle.entry;
+    if (!entry)
+        return;
+
+    if (entry->coverageFrame != frame)
+    {
+        entry->coverageFrame = frame;
+        entry->coverage = 0.f;
+    }
+    entry->coverage = std::max(entry->coverage, pixels);
+}
+
+int TextureRegistry::firstResidentLevel(unsigned int texture, const TextureImage& image)
+{
+    TextureHandle::Entry* entry = find(texture);
+    if (!entry || !image.valid())
+        return 0;
+
+    entry->width = image.levels[0].width;
+    entry->height = image.levels[0].height;
+    entry->levels = int(image.levels.size());
+    entry->channels = image.channels;
+
+    return neededLevel(*entry);
+}
+
+void TextureRegistry::setResident(unsigned int texture, const TextureImage& image, int firstLevel)
+{
+    TextureHandle::Entry* entry = find(texture);
+    if (!entry)
+        return;
+
+    residentBytes -= entry->bytes;
+    entry->bytes = image.valid() ? image.pixels.size() - image.levels[firstLevel].offset : 0;
+    entry->streaming = false;
+    entry->residentLevel = image.valid() ? firstLevel : 0;
+    entry->detailFrame = frame;
+    residentBytes += entry->bytes;
+
+    // the packed copy holds the previous image, the texture is drawn from its own name until the next pack
+    entry->slot = TextureSlot();
+    residencyDirty = true;
+    residencyFrame = frame;
+}
+
+void TextureRegistry::cancelStreaming(unsigned int texture)
+{
+    TextureHandle::Entry* entry = find(texture);
+    if (entry)
+        entry->streaming = false;
+}
+
+void TextureRegistry::release(TextureHandle::Entry* entry)
+{
+    if (entry->refCount > 0)
+        --entry->refCount;
+
+    entry->lastUsed = frame;
+}
+
+void TextureRegistry::evict()
+{
+    if (residentBytes <= budget)
+    {
+        overBudgetReported = false;
+        return;
+    }
+
+    std::vector<std::map<std::string, TextureHandle::Entry>::iterator> unused;
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        // a streaming texture still has an upload queued on its name
+        if (it->second.refCount == 0 && !it->second.streaming)
+            unused.push_back(it);
+    }
+
+    std::sort(unused.begin(), unused.end(), [](const auto& a, const auto& b)
+    {
+        return a->second.lastUsed < b->second.lastUsed;
+    });
+
+    for (size_t i = 0; i < unused.size() && residentBytes > budget; ++i)
+    {
+        TextureHandle::Entry& entry = unused[i]->second;
+
+        std::string statement = "Texture evicted: " + entry.file + " | " + std::to_string(entry.bytes / 1024) + " KB";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
+
+        glDeleteTextures(1, &entry.texture);
+        residentBytes -= entry.bytes;
+        ++evictions;
+        entries.erase(unused[i]);
+        packingDirty = true;
+    }
+
+    if (residentBytes > budget && !overBudgetReported)
+    {
+        std::string statement = "Texture budget exceeded by referenced textures: " + std::to_string(residentBytes / (1024 * 1024))
+            + " MB resident for " + std::to_string(budget / (1024 * 1024)) + " MB";
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        overBudgetReported = true;
+    }
+}
+
+int TextureRegistry::neededLevel(const TextureHandle::Entry& entry) const
+{
+    if (!mipStreaming || entry.levels <= 1)
+        return 0;
+
+    // the texture is taken as spanning the object once: level n has size / 2^n texels
+    float size = float(std::max(entry.width, entry.height));
+    bool seen = entry.coverageFrame + 1 >= frame;
+    float pixels = seen ? entry.coverage : float(unseenSize);
+
+    int level = 0;
+    if (pixels < size)
+        level = int(std::floor(std::log2(size / std::max(pixels, 1.f)) + mipBias)) + budgetBias;
+
+    return std::clamp(level, 0, entry.levels - 1);
+}
+
+void TextureRegistry::streamMips()
+{
+    unsigned int requests = 0;
+    unsigned int trims = 0;
+
+    for (auto& it : entries)
+    {
+        TextureHandle::Entry& entry = it.second;
+        if (entry.streaming || entry.levels == 0)
+            continue;
+
+        int needed = neededLevel(entry);
+        if (needed <= entry.residentLevel)
+            entry.detailFrame = frame;
+
+        if (needed < entry.residentLevel && requests < mipRequestsPerFrame)
+        {
+            // decoded again, the upload keeps the levels needed by then
+            entry.streaming = true;
+            TextureStreamer::getInstance().reload(entry.file, entry.texture);
+            ++requests;
+            ++mipStreams;
+        }
+        else if (needed > entry.residentLevel && trims < mipRequestsPerFrame
+            && (frame - entry.detailFrame >= mipDropDelay || residentBytes > budget))
+        {
+            trim(entry, needed);
+            ++trims;
+            ++mipTrims;
+        }
+    }
+
+    // the referenced textures alone are over the budget: every texture drops a level, until well under it
+    if (mipStreaming && frame % 30 == 0)
+    {
+        if (residentBytes > budget && budgetBias < 8)
+            ++budgetBias;
+        else if (residentBytes < budget / 4 * 3 && budgetBias > 0)
+            --budgetBias;
+    }
+    else if (!mipStreaming)
+    {
+        budgetBias = 0;
+    }
+}
+
+void TextureRegistry::trim(TextureHandle::Entry& entry, int level)
+{
+    // the coarser levels are already on the GPU, they are read back instead of decoding the file again
+    TextureImage image;
+    image.channels = entry.channels;
+
+    size_t offset = 0;
+    for (int i = level; i < entry.levels; ++i)
+    {
+        TextureImage::Level mip;
+        mip.width = std::max(entry.width >> i, 1);
+        mip.height = std::max(entry.height >> i, 1);
+        mip.offset = offset;
+        offset += size_t(mip.width) * size_t(mip.height) * size_t(entry.channels);
+        image.levels.push_back(mip);
+    }
+    image.pixels.resize(offset);
+
+    const GLenum formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+    GLenum format = formats[std::clamp(entry.channels, 1, 4) - 1];
+
+    glBindTexture(GL_TEXTURE_2D, entry.texture);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    for (size_t i = 0; i < image.levels.size(); ++i)
+        glGetTexImage(GL_TEXTURE_2D, GLint(level - entry.residentLevel + int(i)), format, GL_UNSIGNED_BYTE, image.pixels.data() + image.levels[i].offset);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    Texture texture;
+    texture.texCount = entry.texture;
+    texture.upload(entry.file, image);
+
+    std::string statement = "Texture trimmed: " + entry.file + " | level " + std::to_string(entry.residentLevel) + " -> "
+        + std::to_string(level) + " | " + std::to_string(entry.bytes / 1024) + " KB -> " + std::to_string(image.pixels.size() / 1024) + " KB";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
+
+    residentBytes -= entry.bytes;
+    entry.bytes = image.pixels.size();
+    entry.residentLevel = level;
+    residentBytes += entry.bytes;
+
+    entry.slot = TextureSlot();
+    residencyDirty = true;
+    residencyFrame = frame;
+}
+
+void TextureRegistry::endFrame()
+{
+    streamMips();
+    ++frame;
+    evict();
+    pack();
+
+    if (csvEnabled)
+        writeCsv();
+    else if (csv.is_open())
+        csv.close();
+}
+
+void TextureRegistry::pack()
+{
+    if (TexturePacker::enabled != packingEnabled)
+    {
+        packingEnabled = TexturePacker::enabled;
+        packingDirty = true;
+    }
+
+    // every pack copies all the arrays and atlas pages again: while objects move the mip levels change
+    // all the time, so those changes wait until the levels have settled
+    bool settled = residencyDirty && frame - residencyFrame >= repackDelay;
+
+    // a texture still streaming would be packed as its placeholder
+    if (!(packingDirty || settled) || TextureStreamer::getInstance().pendingCount() > 0)
+        return;
+
+    std::vector<TextureHandle::Entry*> packed;
+    for (auto& it : entries)
+    {
+        if (it.second.refCount > 0 && !it.second.streaming)
+            packed.push_back(&it.second);
+        else
+            it.second.slot = TextureSlot();
+    }
+
+    if (packingEnabled)
+        TexturePacker::getInstance().pack(packed);
+    else
+        TexturePacker::getInstance().clear(packed);
+
+    packingDirty = false;
+    residencyDirty = false;
+}
+
+void TextureRegistry::writeCsv()
+{
+    if (!csv.is_open())
+    {
+        csv.open("Logs/texture_stats.csv", std::ofstream::trunc);
+        csv << "frame,resident_bytes,textures,referenced,hits,misses,evictions\n";
+    }
+
+    size_t referenced = 0;
+    for (const auto& it : entries)
+    {
+        if (it.second.refCount > 0)
+            ++referenced;
+    }
+
+    csv << frame << ',' << residentBytes << ',' << entries.size() << ',' << referenced << ','
+        << hits << ',' << misses << ',' << evictions << '\n';
+}
+
+void TextureRegistry::showImGuiControls()
+{
+    size_t referenced = 0;
+    for (const auto& it : entries)
+    {
+        if (it.second.refCount > 0)
+            ++referenced;
+    }
+
+    int budgetMB = int(budget / (1024 * 1024));
+    if (ImGui::SliderInt("Texture budget (MB)", &budgetMB, 16, 4096))
+        budget = size_t(budgetMB) * 1024 * 1024;
+
+    ImGui::Text("Textures resident: %.2f MB | %d textures, %d referenced",
+        float(residentBytes) / (1024.f * 1024.f), int(entries.size()), int(referenced));
+    ImGui::Text("Texture hits: %d | misses: %d | evictions: %d", int(hits), int(misses), int(evictions));
+    ImGui::Checkbox("Texture stats CSV", &csvEnabled);
+
+    ImGui::Checkbox("Mip streaming", &mipStreaming);
+    ImGui::SliderFloat("Mip bias", &mipBias, -4.f, 4.f);
+    ImGui::SliderInt("Unseen texture size", &unseenSize, 1, 1024);
+    int delay = int(repackDelay);
+    if (ImGui::SliderInt("Repack delay (frames)", &delay, 0, 600))
+        repackDelay = static_cast<unsigned int>(delay);
+    ImGui::Text("Mip streams: %d | trims: %d | budget bias: %d", int(mipStreams), int(mipTrims), budgetBias);
+    TexturePacker::getInstance().showImGuiControls();
+}
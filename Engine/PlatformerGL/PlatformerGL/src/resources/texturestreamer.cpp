@@ -0,0 +1,132 @@
+#include <chrono>
+
+#include <glad/glad.h>
+
+#include "resources/texturestreamer.hpp"
+#include "resources/texture.hpp"
+#include "resources/textureregistry.hpp"
+#include "core/datastructure/threadpool.hpp"
+#include "core/debug/log.hpp"
+#include "core/debug/loadprofiler.hpp"
+
+using namespace Resources;
+
+float TextureStreamer::uploadBudget = 2.f;
+size_t TextureStreamer::queueCapacity = 8;
+
+TextureStreamer::TextureStreamer()
+    : state(std::make_shared<State>(queueCapacity))
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    state->decoded.close();
+}
+
+unsigned int TextureStreamer::request(const std::string& textureFile)
+{
+    Texture texture;
+    unsigned int name = texture.bindTexture();
+
+    const unsigned char placeholder[4] = { 200, 200, 200, 255 };
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+
+    submit(textureFile, name, false);
+
+    return name;
+}
+
+void TextureStreamer::reload(const std::string& textureFile, unsigned int texture)
+{
+    submit(textureFile, texture, true);
+}
+
+void TextureStreamer::submit(const std::string& textureFile, unsigned int texture, bool reload)
+{
+    ++state->pending;
+    waiting.push_back({ textureFile, texture, reload });
+    startDecodes();
+}
+
+void TextureStreamer::startDecodes()
+{
+    // every started decode has a slot in the queue, the jobs never wait for the main thread
+    while (decoding < state->decoded.getCapacity() && !waiting.empty())
+    {
+        Request request = std::move(waiting.front());
+        waiting.pop_front();
+        ++decoding;
+
+        std::shared_ptr<State> shared = state;
+        Core::DataStructure::ThreadPool::getInstance().submit([shared, request]()
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            DecodedImage image;
+            image.file = request.file;
+            image.texture = request.texture;
+            image.reload = request.reload;
+            if (Texture::decode(request.file, image.image))
+                Texture::generateMips(image.image);
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            std::string statement = "Texture decoded: " + request.file + " | " + std::to_string(image.image.channels) + " channels, "
+                + std::to_string(image.image.levels.size()) + " levels in " + std::to_string(elapsed.count()) + " ms";
+            Core::Debug::Log::print(statement, Core::Debug::LogType::DEBUG);
+            Core::Debug::LoadProfiler::getInstance().record(Core::Debug::LoadStage::TEXTURE_DECODE, request.file, elapsed.count(),
+                image.image.pixels.size());
+
+            // fails only once the streamer is gone
+            if (!shared->decoded.tryPush(image))
+                --shared->pending;
+        });
+    }
+}
+
+void TextureStreamer::processUploads()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    DecodedImage image;
+    while (state->decoded.tryPop(image))
+    {
+        --decoding;
+
+        // a file caught while it is being written is read again on its next change
+        if (image.reload && !image.image.valid())
+        {
+            std::string statement = "Texture reload failed, previous image kept: " + image.file;
+            Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+
+            TextureRegistry::getInstance().cancelStreaming(image.texture);
+            --state->pending;
+            continue;
+        }
+
+        auto uploadStart = std::chrono::steady_clock::now();
+        glBindTexture(GL_TEXTURE_2D, image.texture);
+
+        // only the levels the objects currently need go to the GPU
+        TextureRegistry& registry = TextureRegistry::getInstance();
+        int firstLevel = registry.firstResidentLevel(image.texture, image.image);
+
+        Texture texture;
+        texture.texCount = image.texture;
+        texture.upload(image.file, image.image, firstLevel);
+        registry.setResident(image.texture, image.image, firstLevel);
+
+        std::chrono::duration<double, std::milli> uploadTime = std::chrono::steady_clock::now() - uploadStart;
+        size_t uploadBytes = image.image.valid() ? image.image.pixels.size() - image.image.levels[firstLevel].offset : 0;
+        Core::Debug::LoadProfiler::getInstance().record(Core::Debug::LoadStage::GL_UPLOAD, image.file, uploadTime.count(), uploadBytes);
+
+        image.image = TextureImage();
+        --state->pending;
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= uploadBudget)
+            break;
+    }
+
+    startDecodes();
+}
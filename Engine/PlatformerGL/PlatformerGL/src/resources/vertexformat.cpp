@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "resources/vertexformat.hpp"
+
+using namespace Resources;
+using namespace Core::Maths;
+
+bool VertexPacker::quantizePositions = true;
+bool VertexPacker::reportError = false;
+
+namespace
+{
+    int16_t toSnorm16(float value)
+    {
+        return int16_t(std::lround(std::clamp(value, -1.f, 1.f) * 32767.f));
+    }
+
+    float fromSnorm16(int16_t value)
+    {
+        return std::max(float(value) / 32767.f, -1.f);
+    }
+
+    // round to nearest even, out of range values become infinities
+    uint16_t toHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        uint32_t magnitude = bits & 0x7fffffffu;
+
+        if (magnitude >= 0x7f800000u)
+            return uint16_t(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u));
+        if (magnitude >= 0x477ff000u)
+            return uint16_t(sign | 0x7c00u);
+
+        if (magnitude < 0x38800000u)
+        {
+            // subnormal half
+            float absolute;
+            uint32_t absoluteBits = magnitude;
+            std::memcpy(&absolute, &absoluteBits, sizeof(absolute));
+            return uint16_t(sign | uint32_t(std::nearbyint(absolute * 16777216.f)));
+        }
+
+        uint32_t rounded = magnitude + 0xfffu + ((magnitude >> 13) & 1u);
+        return uint16_t(sign | ((rounded - 0x38000000u) >> 13));
+    }
+
+    float fromHalf(uint16_t value)
+    {
+        uint32_t sign = uint32_t(value & 0x8000u) << 16;
+        uint32_t exponent = (value >> 10) & 0x1fu;
+        uint32_t mantissa = value & 0x3ffu;
+
+        float result;
+        if (exponent == 0)
+            result = float(mantissa) / 16777216.f;
+        else if (exponent == 31)
+            result = mantissa ? NAN : INFINITY;
+        else
+        {
+            uint32_t bits = ((exponent + 112u) << 23) | (mantissa << 13);
+            std::memcpy(&result, &bits, sizeof(result));
+        }
+
+        return sign ? -result : result;
+    }
+
+    void encodeOctahedral(float x, float y, float z, int16_t out[2])
+    {
+        float sum = std::fabs(x) + std::fabs(y) + std::fabs(z);
+        if (sum <= 0.f)
+        {
+            out[0] = 0;
+            out[1] = 0;
+            return;
+        }
+
+        x /= sum;
+        y /= sum;
+        if (z < 0.f)
+        {
+            float foldedX = (1.f - std::fabs(y)) * (x >= 0.f ? 1.f : -1.f);
+            float foldedY = (1.f - std::fabs(x)) * (y >= 0.f ? 1.f : -1.f);
+            x = foldedX;
+            y = foldedY;
+        }
+
+        out[0] = toSnorm16(x);
+        out[1] = toSnorm16(y);
+    }
+
+    // same as octDecode in the vertex shaders
+    vec3 decodeOctahedral(const int16_t in[2])
+    {
+        vec3 n = { fromSnorm16(in[0]), fromSnorm16(in[1]), 0.f };
+        n.z = 1.f - std::fabs(n.x) - std::fabs(n.y);
+
+        float t = std::max(-n.z, 0.f);
+        n.x += n.x >= 0.f ? -t : t;
+        n.y += n.y >= 0.f ? -t : t;
+
+        return normalize(n);
+    }
+
+    template<typename T>
+    void packVertex(const Core::rdrVertex& vertex, T& packed)
+    {
+        encodeOctahedral(vertex.nx, vertex.ny, vertex.nz, packed.normal);
+        packed.texCoord[0] = toHalf(vertex.u);
+        packed.texCoord[1] = toHalf(vertex.v);
+    }
+
+    template<typename T>
+    void packIndices(const std::vector<unsigned int>& indices, std::vector<unsigned char>& data)
+    {
+        data.resize(indices.size() * sizeof(T));
+        T* out = reinterpret_cast<T*>(data.data());
+        for (size_t i = 0; i < indices.size(); ++i)
+            out[i] = T(indices[i]);
+    }
+}
+
+void VertexFormat::apply() const
+{
+    for (const VertexAttribute& attribute : attributes)
+    {
+        glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized,
+            stride, reinterpret_cast<void*>(uintptr_t(attribute.offset)));
+        glEnableVertexAttribArray(attribute.location);
+    }
+}
+
+const VertexFormat& VertexFormat::compact()
+{
+    static const VertexFormat format = { GLsizei(sizeof(CompactVertex)), {
+        { 0, 3, GL_SHORT, GL_TRUE, GLuint(offsetof(CompactVertex, position)) },
+        { 2, 2, GL_SHORT, GL_TRUE, GLuint(offsetof(CompactVertex, normal)) },
+        { 3, 2, GL_HALF_FLOAT, GL_FALSE, GLuint(offsetof(CompactVertex, texCoord)) }
+    } };
+
+    return format;
+}
+
+const VertexFormat& VertexFormat::compactFloatPositions()
+{
+    static const VertexFormat format = { GLsizei(sizeof(CompactFloatVertex)), {
+        { 0, 3, GL_FLOAT, GL_FALSE, GLuint(offsetof(CompactFloatVertex, position)) },
+        { 2, 2, GL_SHORT, GL_TRUE, GLuint(offsetof(CompactFloatVertex, normal)) },
+        { 3, 2, GL_HALF_FLOAT, GL_FALSE, GLuint(offsetof(CompactFloatVertex, texCoord)) }
+    } };
+
+    return format;
+}
+
+void VertexPacker::pack(const std::vector<Core::rdrVertex>& vertices, const std::vector<unsigned int>& indices, PackedMesh& packed)
+{
+    if (quantizePositions && !vertices.empty())
+    {
+        vec3 min = { vertices[0].x, vertices[0].y, vertices[0].z };
+        vec3 max = min;
+        for (const Core::rdrVertex& vertex : vertices)
+        {
+            min = { std::min(min.x, vertex.x), std::min(min.y, vertex.y), std::min(min.z, vertex.z) };
+            max = { std::max(max.x, vertex.x), std::max(max.y, vertex.y), std::max(max.z, vertex.z) };
+        }
+
+        // flat meshes keep a non null scale on their flat axis
+        vec3 extent = (max - min) / 2.f;
+        packed.positionOffset = (min + max) / 2.f;
+        packed.positionScale = { extent.x > 0.f ? extent.x : 1.f, extent.y > 0.f ? extent.y : 1.f, extent.z > 0.f ? extent.z : 1.f };
+
+        packed.format = &VertexFormat::compact();
+        packed.vertexData.resize(vertices.size() * sizeof(CompactVertex));
+        CompactVertex* out = reinterpret_cast<CompactVertex*>(packed.vertexData.data());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            const Core::rdrVertex& vertex = vertices[i];
+            out[i].position[0] = toSnorm16((vertex.x - packed.positionOffset.x) / packed.positionScale.x);
+            out[i].position[1] = toSnorm16((vertex.y - packed.positionOffset.y) / packed.positionScale.y);
+            out[i].position[2] = toSnorm16((vertex.z - packed.positionOffset.z) / packed.positionScale.z);
+            out[i].position[3] = 0;
+            packVertex(vertex, out[i]);
+        }
+    }
+    else
+    {
+        packed.positionScale = { 1.f, 1.f, 1.f };
+        packed.positionOffset = { 0.f, 0.f, 0.f };
+
+        packed.format = &VertexFormat::compactFloatPositions();
+        packed.vertexData.resize(vertices.size() * sizeof(CompactFloatVertex));
+        CompactFloatVertex* out = reinterpret_cast<CompactFloatVertex*>(packed.vertexData.data());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            const Core::rdrVertex& vertex = vertices[i];
+            out[i].position[0] = vertex.x;
+            out[i].position[1] = vertex.y;
+            out[i].position[2] = vertex.z;
+            packVertex(vertex, out[i]);
+        }
+    }
+
+    if (vertices.size() < 65536)
+    {
+        packed.indexType = GL_UNSIGNED_SHORT;
+        packIndices<uint16_t>(indices, packed.indexData);
+    }
+    else
+    {
+        packed.indexType = GL_UNSIGNED_INT;
+        packIndices<uint32_t>(indices, packed.indexData);
+    }
+}
+
+RoundTripError VertexPacker::roundTripError(const std::vector<Core::rdrVertex>& vertices, const PackedMesh& packed)
+{
+    RoundTripError error;
+    bool quantized = packed.format == &VertexFormat::compact();
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Core::rdrVertex& vertex = vertices[i];
+
+        vec3 position;
+        const int16_t* normal;
+        const uint16_t* texCoord;
+        if (quantized)
+        {
+            const CompactVertex& packedVertex = reinterpret_cast<const CompactVertex*>(packed.vertexData.data())[i];
+            position = vec3{ fromSnorm16(packedVertex.position[0]), fromSnorm16(packedVertex.position[1]), fromSnorm16(packedVertex.position[2]) }
+                * packed.positionScale + packed.positionOffset;
+            normal = packedVertex.normal;
+            texCoord = packedVertex.texCoord;
+        }
+        else
+        {
+            const CompactFloatVertex& packedVertex = reinterpret_cast<const CompactFloatVertex*>(packed.vertexData.data())[i];
+            position = { packedVertex.position[0], packedVertex.position[1], packedVertex.position[2] };
+            normal = packedVertex.normal;
+            texCoord = packedVertex.texCoord;
+        }
+
+        error.position = std::max(error.position, mag(position - vec3{ vertex.x, vertex.y, vertex.z }));
+
+        vec3 source = { vertex.nx, vertex.ny, vertex.nz };
+        if (sqrMag(source) > 0.f)
+        {
+            float cosine = std::clamp(dot(normalize(source), decodeOctahedral(normal)), -1.f, 1.f);
+            error.normal = std::max(error.normal, std::acos(cosine) * 180.f / 3.14159265f);
+        }
+
+        error.texCoord = std::max(error.texCoord, std::max(std::fabs(fromHalf(texCoord[0]) - vertex.u), std::fabs(fromHalf(texCoord[1]) - vertex.v)));
+    }
+
+    return error;
+}
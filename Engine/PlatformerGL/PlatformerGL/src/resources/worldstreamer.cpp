@@ -0,0 +1,357 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "resources/worldstreamer.hpp"
+#include "resources/resourcesmanager.hpp"
+#include "resources/scene.hpp"
+#include "resources/scenesnapshot.hpp"
+#include "resources/texturestreamer.hpp"
+#include "core/datastructure/threadpool.hpp"
+#include "core/debug/log.hpp"
+
+using namespace Resources;
+
+bool WorldStreamer::enabled = false;
+float WorldStreamer::cellSize = 32.f;
+float WorldStreamer::radius = 64.f;
+float WorldStreamer::evictMargin = 16.f;
+size_t WorldStreamer::maxLoads = 4;
+size_t WorldStreamer::buildsPerFrame = 1;
+
+namespace
+{
+    const char* indexFile = "index.txt";
+    const char* residentFile = "resident.pglscene";
+
+    std::string cellFile(int x, int z)
+    {
+        return std::to_string(x) + '_' + std::to_string(z) + SceneSnapshot::extension;
+    }
+
+    bool isResident(const ModelInfo& model)
+    {
+        return int(model.attribs.back()) == static_cast<int>(Game::Tag::PLAYER);
+    }
+
+    // "size <cell size>" then one "cell <x> <z> <models>" line per non empty cell
+    bool readIndex(const std::string& file, float& size, std::map<std::pair<int, int>, size_t>& cells)
+    {
+        std::ifstream input(file);
+        if (!input.is_open())
+            return false;
+
+        std::string line;
+        std::string keyword;
+        size = 0.f;
+        cells.clear();
+        while (std::getline(input, line))
+        {
+            std::istringstream stream(line);
+            if (!(stream >> keyword) || keyword[0] == '#')
+                continue;
+
+            int x = 0, z = 0;
+            size_t models = 0;
+            if (keyword == "size")
+                stream >> size;
+            else if (keyword == "cell" && stream >> x >> z >> models)
+                cells[{ x, z }] = models;
+        }
+        return size > 0.f;
+    }
+}
+
+WorldStreamer::~WorldStreamer() = default;
+
+std::string WorldStreamer::directory(const std::string& sceneName)
+{
+    return "Bin/scenes/" + std::filesystem::path(sceneName).stem().string() + ".world/";
+}
+
+bool WorldStreamer::prepare(const std::string& sceneName)
+{
+    std::string source = "Bin/scenes/" + sceneName;
+    std::string index = directory(sceneName) + indexFile;
+
+    // the scenes of the asset pack have no date, their cells are kept as long as the size matches
+    float size = 0.f;
+    std::map<CellKey, size_t> cells;
+    std::error_code error;
+    if (readIndex(index, size, cells) && size == cellSize)
+    {
+        auto sourceTime = std::filesystem::last_write_time(source, error);
+        if (error || std::filesystem::last_write_time(index, error) >= sourceTime)
+            return true;
+    }
+
+    return build(sceneName);
+}
+
+bool WorldStreamer::build(const std::string& sceneName)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::string source = "Bin/scenes/" + sceneName;
+    SceneData data;
+    if (!SceneParser::parseFile(source, data))
+    {
+        std::string statement = "World: unable to read " + source;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    SceneData resident;
+    resident.camera = data.camera;
+    resident.dirLights = data.dirLights;
+    resident.pointLights = data.pointLights;
+    resident.spotLights = data.spotLights;
+
+    std::map<CellKey, SceneData> split;
+    for (ModelInfo& model : data.models)
+    {
+        if (isResident(model))
+        {
+            resident.models.push_back(std::move(model));
+            continue;
+        }
+
+        CellKey cell = { int(std::floor(model.attribs[0] / cellSize)), int(std::floor(model.attribs[2] / cellSize)) };
+        split[cell].models.push_back(std::move(model));
+    }
+
+    // the index is written last, a build that stops halfway is done again
+    std::string folder = directory(sceneName);
+    std::error_code error;
+    std::filesystem::remove_all(folder, error);
+    std::filesystem::create_directories(folder, error);
+
+    bool written = SceneSnapshot::save(folder + residentFile, resident, SceneSnapshot::compressed);
+    std::ostringstream index;
+    index << "# " << sceneName << ": cell size, then x z and models of every cell\n";
+    index << "size " << cellSize << '\n';
+    for (const auto& cell : split)
+    {
+        written = written && SceneSnapshot::save(folder + cellFile(cell.first.first, cell.first.second), cell.second, SceneSnapshot::compressed);
+        index << "cell " << cell.first.first << ' ' << cell.first.second << ' ' << cell.second.models.size() << '\n';
+    }
+
+    if (written)
+    {
+        std::ofstream output(folder + indexFile, std::ios::out | std::ios::trunc);
+        output << index.str();
+        written = output.good();
+    }
+
+    if (!written)
+    {
+        std::string statement = "World: unable to write the cells of " + sceneName + " in " + folder;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::string statement = "World built: " + sceneName + " | " + std::to_string(split.size()) + " cells of "
+        + std::to_string(cellSize) + " units, " + std::to_string(resident.models.size()) + " resident models in "
+        + std::to_string(elapsed.count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+
+    return true;
+}
+
+bool WorldStreamer::loadResident(const std::string& sceneName, SceneData& data)
+{
+    return SceneSnapshot::load(directory(sceneName) + residentFile, data);
+}
+
+void WorldStreamer::keepResident(SceneData& data)
+{
+    data.models.erase(std::remove_if(data.models.begin(), data.models.end(), [](const ModelInfo& model)
+    {
+        return !isResident(model);
+    }), data.models.end());
+}
+
+bool WorldStreamer::addWorld(const std::string& sceneName, SceneData& data)
+{
+    SceneData scene;
+    if (!SceneSnapshot::loadAny("Bin/scenes/" + sceneName, scene))
+        return false;
+
+    for (ModelInfo& model : scene.models)
+    {
+        if (!isResident(model))
+            data.models.push_back(std::move(model));
+    }
+    return true;
+}
+
+bool WorldStreamer::open(const std::string& name)
+{
+    sceneName = name;
+    if (!readIndex(directory(name) + indexFile, size, cells))
+    {
+        std::string statement = "World: no cells for " + name;
+        Core::Debug::Log::print(statement, Core::Debug::LogType::WARNING);
+        return false;
+    }
+
+    std::string statement = "World opened: " + name + " | " + std::to_string(cells.size()) + " cells";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+    return true;
+}
+
+float WorldStreamer::distance(const CellKey& cell, const Core::Maths::vec3& position) const
+{
+    // to the closest point of the cell in the XZ plane
+    float x = std::clamp(position.x, cell.first * size, (cell.first + 1) * size);
+    float z = std::clamp(position.z, cell.second * size, (cell.second + 1) * size);
+    return std::sqrt((position.x - x) * (position.x - x) + (position.z - z) * (position.z - z));
+}
+
+void WorldStreamer::update(Scene& scene, ResourcesManager& rm)
+{
+    if (scene.players.empty() || cells.empty())
+        return;
+
+    const Core::Maths::vec3& position = scene.players[0].transform.position;
+
+    // cells read by the workers, a few built per frame
+    size_t built = 0;
+    for (auto& entry : chunks)
+    {
+        Chunk& chunk = entry.second;
+        if (built >= buildsPerFrame || !chunk.pending.valid()
+            || chunk.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            continue;
+
+        SceneData data = chunk.pending.get();
+        --loadingCells;
+        instantiate(entry.first, data, scene, rm, chunk);
+        ++built;
+    }
+
+    // out of reach, the reads still running are dropped when they end
+    for (auto it = chunks.begin(); it != chunks.end(); )
+    {
+        if (distance(it->first, position) <= radius + evictMargin)
+        {
+            ++it;
+            continue;
+        }
+
+        if (it->second.pending.valid())
+            --loadingCells;
+        else
+            evict(scene, it->second);
+        it = chunks.erase(it);
+    }
+
+    // cells in reach, nearest first
+    int range = int(std::ceil(radius / size));
+    int centerX = int(std::floor(position.x / size));
+    int centerZ = int(std::floor(position.z / size));
+    std::vector<std::pair<float, CellKey>> missing;
+    for (int x = centerX - range; x <= centerX + range; ++x)
+    {
+        for (int z = centerZ - range; z <= centerZ + range; ++z)
+        {
+            CellKey cell = { x, z };
+            float cellDistance = distance(cell, position);
+            if (cellDistance <= radius && cells.count(cell) && !chunks.count(cell))
+                missing.push_back({ cellDistance, cell });
+        }
+    }
+    std::sort(missing.begin(), missing.end());
+
+    for (const auto& cell : missing)
+    {
+        if (loadingCells >= maxLoads)
+            break;
+
+        std::string file = directory(sceneName) + cellFile(cell.second.first, cell.second.second);
+        chunks[cell.second].pending = Core::DataStructure::ThreadPool::getInstance().submit([file]()
+        {
+            SceneData data;
+            SceneSnapshot::load(file, data);
+            return data;
+        });
+        ++loadingCells;
+    }
+}
+
+void WorldStreamer::preload(Scene& scene, ResourcesManager& rm)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // the textures of the built cells keep uploading while the next ones are read
+    update(scene, rm);
+    while (loadingCells > 0)
+    {
+        for (auto& entry : chunks)
+        {
+            if (entry.second.pending.valid())
+                entry.second.pending.wait_for(std::chrono::milliseconds(1));
+        }
+        TextureStreamer::getInstance().processUploads();
+        update(scene, rm);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::string statement = "World preloaded: " + sceneName + " | " + std::to_string(residentCells) + " of "
+        + std::to_string(cells.size()) + " cells, " + std::to_string(streamedObjects) + " objects in "
+        + std::to_string(elapsed.count()) + " ms";
+    Core::Debug::Log::print(statement, Core::Debug::LogType::INFO);
+}
+
+void WorldStreamer::instantiate(const CellKey& cell, SceneData& data, Scene& scene, ResourcesManager& rm, Chunk& chunk)
+{
+    chunk.objects = std::make_unique<Scene>(sceneName + " " + std::to_string(cell.first) + '_' + std::to_string(cell.second));
+    Scene& objects = *chunk.objects;
+
+    // the shaders are built for the lights of the scene
+    objects.dirLights = scene.dirLights;
+    objects.pointLights = scene.pointLights;
+    objects.spotLights = scene.spotLights;
+
+    // the meshes, materials, textures and programs of models seen before come from the caches
+    rm.loadModels(objects, data.models);
+    objects.setGameObjects();
+    for (Game::GameObject* gameObject : objects.gameObjects)
+        gameObject->defineVAO();
+
+    scene.gameObjects.insert(scene.gameObjects.end(), objects.gameObjects.begin(), objects.gameObjects.end());
+    streamedObjects += objects.gameObjects.size();
+    ++residentCells;
+}
+
+void WorldStreamer::evict(Scene& scene, Chunk& chunk)
+{
+    if (!chunk.objects)
+        return;
+
+    std::vector<Game::GameObject*> leaving = chunk.objects->gameObjects;
+    std::sort(leaving.begin(), leaving.end());
+    scene.gameObjects.erase(std::remove_if(scene.gameObjects.begin(), scene.gameObjects.end(), [&leaving](Game::GameObject* gameObject)
+    {
+        return std::binary_search(leaving.begin(), leaving.end(), gameObject);
+    }), scene.gameObjects.end());
+
+    streamedObjects -= leaving.size();
+    --residentCells;
+    chunk.objects.reset();
+}
+
+void WorldStreamer::close(Scene& scene)
+{
+    for (auto& entry : chunks)
+        evict(scene, entry.second);
+
+    chunks.clear();
+    residentCells = 0;
+    loadingCells = 0;
+    streamedObjects = 0;
+}
@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "resources/scenesnapshot.hpp"
+
+namespace fs = std::filesystem;
+using namespace Resources;
+
+namespace
+{
+    // counts and layout of a generated scene, one player included
+    struct Settings
+    {
+        std::string name = "stress";
+        std::string directory = "Bin/scenes";
+        size_t      platforms = 800;
+        size_t      enemies = 199;
+        size_t      dirLights = 1;
+        size_t      pointLights = 4;
+        size_t      spotLights = 1;
+        std::string layout = "uniform";     // uniform, clusters or grid
+        size_t      textures = 8;           // platform textures used, "None" counted
+        float       spacing = 4.f;          // average distance between platforms, sets the size of the level
+        uint32_t    seed = 1;
+        bool        compressed = true;
+    };
+
+    // standard sizes, in objects: a fifth of them enemies
+    const size_t ladder[] = { 1000, 10000, 100000 };
+    const char* ladderNames[] = { "1k", "10k", "100k" };
+
+    const char* textures[] = { "None", "blue_stone.jpg", "cobble.jpg", "emerald_stone.jpg", "sand.jpg",
+        "shingles.jpg", "bumpy_ice.png", "lava_tile.jpg" };
+    const size_t textureCount = sizeof(textures) / sizeof(textures[0]);
+
+    // the light arrays of the shaders are sized by the scene, past this they outgrow the uniforms
+    const size_t maxLights = 32;
+
+    const size_t objectsPerCluster = 250;
+
+    // tag codes of the SCN format
+    const int playerTag = 0;
+    const int enemyTag = 1;
+    const int platformTag = 2;
+
+    struct Position
+    {
+        float x = 0.f;
+        float y = 0.f;
+        float z = 0.f;
+    };
+
+    // mt19937 gives the same numbers everywhere, the standard distributions do not: values are drawn by hand
+    class Random
+    {
+    public:
+        Random(uint32_t seed) : engine(seed) {}
+
+        // [0, 1)
+        float next() { return float(engine() >> 8) * (1.f / 16777216.f); }
+        float range(float min, float max) { return min + (max - min) * next(); }
+        size_t index(size_t count) { return size_t(engine() % uint32_t(count)); }
+
+    private:
+        std::mt19937 engine;
+    };
+
+    bool readNumber(const char* text, size_t& value)
+    {
+        const char* end = text + std::char_traits<char>::length(text);
+        auto result = std::from_chars(text, end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    bool readNumber(const char* text, float& value)
+    {
+        char* end = nullptr;
+        value = std::strtof(text, &end);
+        return end != text && *end == '\0' && value > 0.f;
+    }
+
+    ModelInfo makeModel(const std::string& name, const Position& position, float scale, int tag)
+    {
+        ModelInfo model;
+        model.name = name;
+        model.attribs = { position.x, position.y, position.z, 0.f, 0.f, 0.f, scale, scale, scale, float(tag) };
+        model.shaders = { "shader.vert", "shader.frag", "collider.vert", "collider.frag" };
+        return model;
+    }
+
+    // positions of the platforms in the XZ plane around the origin, kept at the heights of the first level
+    std::vector<Position> placePlatforms(const Settings& settings, Random& random)
+    {
+        std::vector<Position> positions;
+        positions.reserve(settings.platforms);
+
+        // the player starts on the first one
+        positions.push_back({ 0.f, -4.f, 0.f });
+
+        float half = 0.5f * settings.spacing * std::sqrt(float(settings.platforms));
+        if (settings.layout == "grid")
+        {
+            size_t side = size_t(std::ceil(std::sqrt(float(settings.platforms))));
+            for (size_t i = 1; i < settings.platforms; ++i)
+            {
+                float x = float(i % side) * settings.spacing - half;
+                float z = float(i / side) * settings.spacing - half;
+                positions.push_back({ x, -5.f + float(i % 3), z });
+            }
+        }
+        else if (settings.layout == "clusters")
+        {
+            size_t clusterCount = std::max<size_t>(1, settings.platforms / objectsPerCluster);
+            float clusterRadius = 0.5f * settings.spacing * std::sqrt(float(objectsPerCluster));
+            std::vector<Position> centers(clusterCount);
+            for (Position& center : centers)
+                center = { random.range(-half, half), 0.f, random.range(-half, half) };
+
+            // three draws summed lean towards the center of the cluster, drawn in order
+            auto offset = [&random, clusterRadius]()
+            {
+                float sum = random.next();
+                sum += random.next();
+                sum += random.next();
+                return (sum - 1.5f) * clusterRadius;
+            };
+            for (size_t i = 1; i < settings.platforms; ++i)
+            {
+                const Position& center = centers[random.index(clusterCount)];
+                float x = offset();
+                float z = offset();
+                positions.push_back({ center.x + x, random.range(-5.f, -3.f), center.z + z });
+            }
+        }
+        else
+        {
+            for (size_t i = 1; i < settings.platforms; ++i)
+                positions.push_back({ random.range(-half, half), random.range(-5.f, -3.f), random.range(-half, half) });
+        }
+
+        return positions;
+    }
+
+    void generate(const Settings& settings, SceneData& data)
+    {
+        Random random(settings.seed);
+        data = SceneData();
+        data.models.reserve(settings.platforms + settings.enemies + 1);
+
+        std::vector<Position> platforms = placePlatforms(settings, random);
+        size_t textureVariety = std::clamp<size_t>(settings.textures, 1, textureCount);
+        for (const Position& position : platforms)
+        {
+            ModelInfo model = makeModel("platform", position, 1.f, platformTag);
+            model.colliderName = "cube";
+            model.colliderAttribs = { 0.f, -5.f, 0.f, 1.f, 1.f, 1.f };
+            model.gameObjectAttribs = { 0 };
+            model.customTexture = textures[random.index(textureVariety)];
+            data.models.push_back(std::move(model));
+        }
+
+        // standing on a platform other than the first one
+        for (size_t i = 0; i < settings.enemies; ++i)
+        {
+            Position position = platforms[platforms.size() > 1 ? 1 + random.index(platforms.size() - 1) : 0];
+            position.y += 4.f;
+            ModelInfo model = makeModel("darkmonk", position, 1.f, enemyTag);
+            model.colliderName = "sphere";
+            model.colliderAttribs = { 0.f, 0.f, 0.f, 1.f, 1.f, 1.f };
+            model.gameObjectAttribs = { 1 };
+            data.models.push_back(std::move(model));
+        }
+
+        ModelInfo player = makeModel("ahsoka", { 0.f, 0.f, 0.3f }, 0.5f, playerTag);
+        player.colliderName = "sphere";
+        player.colliderAttribs = { 0.f, 0.f, 0.f, 1.f, 1.f, 1.f };
+        player.gameObjectAttribs = { 5 };
+        data.models.push_back(std::move(player));
+
+        data.camera = { 0.175f, 0.474f, 2.5f, 0.f, 0.f, 60.f, 0.01f, 1000.f, 0.002f, 1.f };
+
+        // colors of the first level, positions spread over the level
+        float half = 0.5f * settings.spacing * std::sqrt(float(std::max<size_t>(settings.platforms, 1)));
+        for (size_t i = 0; i < std::min(settings.dirLights, maxLights); ++i)
+        {
+            data.dirLights.push_back({ 1.f, 0.4f, 0.4f, 0.4f, 0.4f, 0.4f, 0.1f, 0.2f, 0.4f, 0.5f,
+                random.range(-1.f, 1.f), -1.f, random.range(-1.f, 1.f) });
+        }
+        for (size_t i = 0; i < std::min(settings.pointLights, maxLights); ++i)
+        {
+            data.pointLights.push_back({ 1.f, random.next(), random.next(), random.next(), 0.1f, 0.4f, 0.7f, 0.8f, 0.4f, 0.5f,
+                random.range(-half, half), random.range(-2.f, 2.f), random.range(-half, half), 0.68f, 0.035f, 0.603f });
+        }
+        for (size_t i = 0; i < std::min(settings.spotLights, maxLights); ++i)
+        {
+            data.spotLights.push_back({ 1.f, 1.f, 1.f, 1.f, 0.1f, 0.4f, 0.7f, 1.f, 0.4f, 0.5f, 3.f, 0.3f, 0.35f,
+                random.range(-half, half), -21.f, random.range(-half, half), 0.f, 1.f, 0.f, 6.f });
+        }
+    }
+
+    // both files written, then read back through the loaders of the game
+    bool write(const Settings& settings)
+    {
+        SceneData data;
+        generate(settings, data);
+
+        std::error_code error;
+        fs::create_directories(settings.directory, error);
+        std::string base = (fs::path(settings.directory) / settings.name).generic_string();
+        std::string textFile = base + ".scn";
+        std::string snapshotFile = base + SceneSnapshot::extension;
+        if (!SceneSnapshot::saveText(textFile, data) || !SceneSnapshot::save(snapshotFile, data, settings.compressed))
+        {
+            std::cerr << "Unable to write " << base << std::endl;
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        SceneData parsed;
+        bool checked = SceneParser::parseFile(textFile, parsed) && parsed.errorCount == 0;
+        std::chrono::duration<double, std::milli> parseTime = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        SceneData loaded;
+        checked = checked && SceneSnapshot::load(snapshotFile, loaded);
+        std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - start;
+
+        if (!checked || parsed.models.size() != data.models.size() || loaded.models.size() != data.models.size())
+        {
+            std::cerr << "Scene check failed: " << base << std::endl;
+            return false;
+        }
+
+        std::cout << settings.name << ": " << settings.platforms << " platforms, " << settings.enemies << " enemies, "
+            << data.dirLights.size() + data.pointLights.size() + data.spotLights.size() << " lights, "
+            << settings.layout << " layout, seed " << settings.seed << " | "
+            << fs::file_size(textFile, error) / 1024 << " KB parsed in " << parseTime.count() << " ms, "
+            << fs::file_size(snapshotFile, error) / 1024 << " KB snapshot loaded in " << loadTime.count() << " ms" << std::endl;
+        return true;
+    }
+
+    void printUsage()
+    {
+        std::cerr << "SceneGenerator [--ladder] [-n name] [-o directory] [--platforms count] [--enemies count]\n"
+            << "    [--lights directional point spot] [--layout uniform|clusters|grid] [--textures count]\n"
+            << "    [--spacing units] [--seed number] [--store]" << std::endl;
+    }
+}
+
+// writes stress scenes for the scaling measurements, the same arguments giving the same files:
+// <name>.scn and <name>.pglscene in Bin/scenes, run from the project directory. --ladder writes
+// stress_1k, stress_10k and stress_100k with the other settings
+int main(int argc, char** argv)
+{
+    Settings settings;
+    bool writeLadder = false;
+    bool valid = true;
+
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        size_t seed = 0;
+        if (argument == "--ladder")
+            writeLadder = true;
+        else if (argument == "--store")
+            settings.compressed = false;
+        else if (argument == "-n" && hasValue)
+            settings.name = argv[++i];
+        else if (argument == "-o" && hasValue)
+            settings.directory = argv[++i];
+        else if (argument == "--platforms" && hasValue)
+            valid = readNumber(argv[++i], settings.platforms);
+        else if (argument == "--enemies" && hasValue)
+            valid = readNumber(argv[++i], settings.enemies);
+        else if (argument == "--lights" && i + 3 < argc)
+        {
+            valid = readNumber(argv[i + 1], settings.dirLights) && readNumber(argv[i + 2], settings.pointLights)
+                && readNumber(argv[i + 3], settings.spotLights);
+            i += 3;
+        }
+        else if (argument == "--layout" && hasValue)
+        {
+            settings.layout = argv[++i];
+            valid = settings.layout == "uniform" || settings.layout == "clusters" || settings.layout == "grid";
+        }
+        else if (argument == "--textures" && hasValue)
+            valid = readNumber(argv[++i], settings.textures);
+        else if (argument == "--spacing" && hasValue)
+            valid = readNumber(argv[++i], settings.spacing);
+        else if (argument == "--seed" && hasValue)
+        {
+            valid = readNumber(argv[++i], seed);
+            settings.seed = uint32_t(seed);
+        }
+        else
+            valid = false;
+    }
+
+    if (!valid || settings.platforms == 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (settings.dirLights > maxLights || settings.pointLights > maxLights || settings.spotLights > maxLights)
+        std::cerr << "Light counts are limited to " << maxLights << " of each kind" << std::endl;
+
+    if (!writeLadder)
+        return write(settings) ? 0 : 1;
+
+    for (size_t i = 0; i < sizeof(ladder) / sizeof(ladder[0]); ++i)
+    {
+        Settings step = settings;
+        step.name = std::string("stress_") + ladderNames[i];
+        step.enemies = ladder[i] / 5;
+        step.platforms = ladder[i] - step.enemies - 1;
+        if (!write(step))
+            return 1;
+    }
+
+    return 0;
+}